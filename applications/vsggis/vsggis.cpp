@@ -1,9 +1,11 @@
 #include <vsg/all.h>
 
+#include <algorithm>
 #include <chrono>
 #include <ostream>
 #include <thread>
 
+#include <vsgGIS/PyramidBuilder.h>
 #include <vsgGIS/gdal_utils.h>
 #include <vsgGIS/meta_utils.h>
 
@@ -13,20 +15,125 @@ int main(int argc, char** argv)
 
     vsg::CommandLine arguments(&argc, argv);
 
+    // number of threads used to read each dataset, each opening its own GDALDataset, 1 reads on the main thread only
+    auto numThreads = arguments.value<uint32_t>(std::max(std::thread::hardware_concurrency(), 1u), "--threads");
+
+    // size in pixels of the windows the raster is converted in, bounding peak memory to a single window, 0 converts the whole raster into a single image
+    auto windowSize = arguments.value<int>(0, "--window");
+
+    // build a z/x/y tile pyramid for a TileDatabase rather than a single image, the output is then the tile filename template i.e. tiles/{z}/{x}/{y}.vsgb,
+    // or tiles/{z}/{x}/{y}.vsgm for tiles that the TileDatabase memory maps rather than deserializes
+    bool pyramid = arguments.read("--pyramid");
+    auto tileSize = arguments.value<uint32_t>(256, "--tile-size");
+    auto maxLevel = arguments.value<uint32_t>(0, "--max-level");
+    bool mercator = arguments.read("--mercator");
+    auto databaseFilename = arguments.value<std::string>("", "--database");
+
+    // store box filtered mipmap chains, of up to n levels stopping at min-mipmap-size pixels, with the pyramid tiles so they aren't generated as the tiles are uploaded
+    auto mipmapLevels = arguments.value<uint32_t>(0, "--mipmaps");
+    auto minMipmapSize = arguments.value<uint32_t>(1, "--min-mipmap-size");
+
+    // mosaic inputs that share a projection but aren't pixel aligned, i.e. adjacent tiles, into a single VRT rather than merging their bands
+    bool mosaic = arguments.read("--mosaic");
+
+    // write a copy of a TileDatabase with a StartupBundle of its compiled shaders and root tiles, write it as .vsgb so the bundle is read back without parsing,
+    // with --no-root-tiles only the shaders are bundled and the root tiles are paged in once the database is displayed
+    bool startupBundle = arguments.read("--startup-bundle");
+    bool noRootTiles = arguments.read("--no-root-tiles");
+
     if (argc < 3)
     {
-        vsg::info("usage:\n    vsggis input.tif [input.tif] [input.tif] [inputfile.tif] output.vsgt");
+        vsg::info("usage:\n    vsggis [--threads n] [--window size] [--mosaic] input.tif [input.tif] [input.tif] [inputfile.tif] output.vsgt");
+        vsg::info("    vsggis --pyramid [--threads n] [--tile-size 256] [--max-level n] [--mercator] [--mipmaps n] [--min-mipmap-size 1] [--database tiles.vsgt] input.tif [input.tif] tiles/{z}/{x}/{y}.vsgb");
+        vsg::info("    vsggis --startup-bundle [--no-root-tiles] database.vsgt database.vsgb");
         return 1;
     }
 
-    std::vector<std::shared_ptr<GDALDataset>> datasets;
+    if (pyramid)
+    {
+        std::vector<vsg::Path> sources;
+        for (int ai = 1; ai < argc - 1; ++ai) sources.push_back(arguments[ai]);
+
+        auto builder = vsgGIS::PyramidBuilder::create();
+        builder->tileSize = tileSize;
+        builder->maxLevel = maxLevel;
+        builder->numThreads = numThreads;
+        builder->mipmapLevels = mipmapLevels;
+        builder->minMipmapSize = minMipmapSize;
+        builder->settings->imageLayer = arguments[argc - 1];
+        if (mercator)
+        {
+            builder->settings->projection = "EPSG:3857";
+            builder->settings->noX = 1;
+            builder->settings->noY = 1;
+        }
+
+        if (!builder->build(sources))
+        {
+            vsg::info("Failed to build pyramid ", builder->settings->imageLayer);
+            return 1;
+        }
+
+        vsg::info("Written ", builder->numTilesWritten.load(), " tiles, levels 0 to ", builder->settings->maxLevel, ", to ", builder->settings->imageLayer);
+
+        if (!databaseFilename.empty())
+        {
+            // TileDatabase that pages in the local pyramid
+            auto database = vsgGIS::TileDatabase::create();
+            database->settings = builder->settings;
+            vsg::write(database, databaseFilename);
+
+            vsg::info("Written database to ", databaseFilename);
+        }
+
+        return 0;
+    }
 
-    for (int ai = 1; ai < argc - 1; ++ai)
+    if (startupBundle)
     {
-        auto dataset = vsgGIS::openSharedDataSet(arguments[ai], GA_ReadOnly);
-        if (dataset)
+        auto options = vsg::Options::create();
+        options->paths = vsg::getEnvPaths("VSG_FILE_PATH");
+
+        auto source = vsg::read_cast<vsgGIS::TileDatabase>(arguments[1], options);
+        if (!source || !source->tileReader)
+        {
+            vsg::info("Failed to read database ", arguments[1]);
+            return 1;
+        }
+
+        auto database = vsgGIS::TileDatabase::create();
+        database->settings = source->settings;
+        database->startupBundle = source->tileReader->createStartupBundle(!noRootTiles, options);
+
+        vsg::Path output_filename = arguments[argc - 1];
+        if (!vsg::write(database, output_filename))
+        {
+            vsg::info("Failed to write database ", output_filename);
+            return 1;
+        }
+
+        vsg::info("Written database with ", database->startupBundle->rootImages.size(), " bundled root tiles to ", output_filename);
+
+        return 0;
+    }
+
+    std::vector<vsg::Path> inputFilenames;
+    for (int ai = 1; ai < argc - 1; ++ai) inputFilenames.push_back(arguments[ai]);
+
+    // open the inputs concurrently, capturing the signature of each so the compatibility checks are cheap comparisons
+    std::vector<vsgGIS::DatasetSignature> inputSignatures;
+    auto inputDatasets = vsgGIS::openDataSets(inputFilenames, GA_ReadOnly, numThreads, &inputSignatures);
+
+    std::vector<std::shared_ptr<GDALDataset>> datasets;
+    std::vector<vsg::Path> filenames;
+    std::vector<vsgGIS::DatasetSignature> signatures;
+    for (size_t i = 0; i < inputDatasets.size(); ++i)
+    {
+        if (inputDatasets[i])
         {
-            datasets.push_back(dataset);
+            datasets.push_back(inputDatasets[i]);
+            filenames.push_back(inputFilenames[i]);
+            signatures.push_back(inputSignatures[i]);
         }
     }
 
@@ -36,11 +143,40 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    bool result = vsgGIS::all_equal(datasets.begin(), datasets.end(), vsgGIS::compatibleDatasetProjectionsTransformAndSizes);
-    if (!result)
+    auto compatible = [&](auto compare) {
+        return std::all_of(signatures.begin(), signatures.end(), [&](const vsgGIS::DatasetSignature& signature) { return (signatures.front().*compare)(signature); });
+    };
+
+    // the mosaic's VRT is written to GDAL's in memory file system so the reading threads can each open it
+    vsg::Path mosaicFilename("/vsimem/vsggis_mosaic.vrt");
+    bool usingMosaic = false;
+
+    if (!compatible(&vsgGIS::DatasetSignature::compatibleProjectionTransformAndSize))
     {
-        vsg::info("datasets are not compatible.");
-        return 1;
+        if (!mosaic)
+        {
+            vsg::info("datasets are not compatible, use --mosaic to combine datasets that are adjacent rather than pixel aligned.");
+            return 1;
+        }
+
+        if (!compatible(&vsgGIS::DatasetSignature::compatibleProjection))
+        {
+            vsg::info("datasets do not share a projection so can not be mosaiced.");
+            return 1;
+        }
+
+        auto mosaicDataset = vsgGIS::createMosaic(datasets, mosaicFilename);
+        if (!mosaicDataset)
+        {
+            vsg::info("failed to mosaic datasets, the datasets must have the same raster bands.");
+            return 1;
+        }
+
+        vsg::info("mosaiced ", datasets.size(), " datasets.");
+
+        datasets = {mosaicDataset};
+        filenames = {mosaicFilename};
+        usingMosaic = true;
     }
 
     auto types = vsgGIS::dataTypes(datasets.begin(), datasets.end());
@@ -64,8 +200,10 @@ int main(int argc, char** argv)
     int height = main_dataset->GetRasterYSize();
 
     std::vector<GDALRasterBand*> rasterBands;
+    std::vector<std::vector<int>> datasetBands;
     for (auto& dataset : datasets)
     {
+        datasetBands.emplace_back();
         for (int i = 1; i <= dataset->GetRasterCount(); ++i)
         {
             GDALRasterBand* band = dataset->GetRasterBand(i);
@@ -74,6 +212,7 @@ int main(int argc, char** argv)
             if (classification != GCI_Undefined)
             {
                 rasterBands.push_back(band);
+                datasetBands.back().push_back(i);
             }
             else
             {
@@ -93,30 +232,96 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    auto image = vsgGIS::createImage2D(width, height, numComponents, dataType, vsg::dvec4(0.0, 0.0, 0.0, 1.0));
+    double geoTransform[6];
+    bool hasGeoTransform = main_dataset->GetGeoTransform(geoTransform) == CE_None;
 
-    for (int component = 0; component < static_cast<int>(rasterBands.size()); ++component)
-    {
-        vsgGIS::copyRasterBandToImage(*rasterBands[component], *image, component);
-    }
+    // read the window of the inputs at x, y into a single image along with the projection and geo transform of the window
+    auto readWindow = [&](int x, int y, int windowWidth, int windowHeight) -> vsg::ref_ptr<vsg::Data> {
+        auto image = vsgGIS::createImage2D(windowWidth, windowHeight, numComponents, dataType, vsg::dvec4(0.0, 0.0, 0.0, 1.0));
+        if (!image) return {};
 
-    if (main_dataset->GetProjectionRef())
-    {
-        image->setValue("ProjectionRef", std::string(main_dataset->GetProjectionRef()));
-    }
+        // read all the bands of each dataset in one pass, falling back to band by band copies if that fails
+        int component = 0;
+        for (size_t di = 0; di < datasets.size(); ++di)
+        {
+            auto& bands = datasetBands[di];
+            if (!vsgGIS::copyRasterBandsWindowToImage(filenames[di], bands, x, y, *image, component, numThreads))
+            {
+                vsg::info("Could not read ", filenames[di], " in one pass, copying band by band.");
+                for (size_t bi = 0; bi < bands.size(); ++bi)
+                {
+                    vsgGIS::copyRasterBandWindowToImage(*rasterBands[component + bi], x, y, *image, component + static_cast<int>(bi));
+                }
+            }
+            component += static_cast<int>(bands.size());
+        }
+
+        if (main_dataset->GetProjectionRef())
+        {
+            image->setValue("ProjectionRef", std::string(main_dataset->GetProjectionRef()));
+        }
+
+        if (hasGeoTransform)
+        {
+            // shift the origin of the geo transform to the window's top left corner
+            auto transform = vsg::doubleArray::create(6);
+            std::copy(geoTransform, geoTransform + 6, transform->data());
+            (*transform)[0] = geoTransform[0] + double(x) * geoTransform[1] + double(y) * geoTransform[2];
+            (*transform)[3] = geoTransform[3] + double(x) * geoTransform[4] + double(y) * geoTransform[5];
+            image->setObject("GeoTransform", transform);
+        }
+
+        vsgGIS::assignMetaData(*main_dataset, *image);
+
+        return image;
+    };
+
+    vsg::Path output_filename = arguments[argc - 1];
 
-    auto transform = vsg::doubleArray::create(6);
-    if (main_dataset->GetGeoTransform(transform->data()) == CE_None)
+    if (windowSize == 0 || (width <= windowSize && height <= windowSize))
     {
-        image->setObject("GeoTransform", transform);
+        auto image = readWindow(0, 0, width, height);
+        vsg::write(image, output_filename);
+
+        vsg::info("Written output to ", output_filename);
     }
+    else
+    {
+        // walk the raster a window at a time so only one window is held in memory, each written to its own file with {x} and {y} replaced by the window column and row
+        if (output_filename.find("{x}") == vsg::Path::npos || output_filename.find("{y}") == vsg::Path::npos)
+        {
+            output_filename = vsg::Path(vsg::removeExtension(output_filename).string() + "_{x}_{y}" + vsg::fileExtension(output_filename).string());
+        }
 
-    vsgGIS::assignMetaData(*main_dataset, *image);
+        auto replace = [](vsg::Path& path, const std::string& match, int value) {
+            auto pos = path.find(match);
+            if (pos != vsg::Path::npos) path.replace(pos, match.length(), vsg::make_string(value));
+        };
 
-    vsg::Path output_filename = arguments[argc - 1];
-    vsg::write(image, output_filename);
+        int numWindowsX = (width + windowSize - 1) / windowSize;
+        int numWindowsY = (height + windowSize - 1) / windowSize;
+
+        vsg::info("Converting ", numWindowsX, " x ", numWindowsY, " windows of ", windowSize, " x ", windowSize);
+
+        for (int wy = 0; wy < numWindowsY; ++wy)
+        {
+            for (int wx = 0; wx < numWindowsX; ++wx)
+            {
+                int x = wx * windowSize;
+                int y = wy * windowSize;
+                auto image = readWindow(x, y, std::min(windowSize, width - x), std::min(windowSize, height - y));
+
+                vsg::Path window_filename = output_filename;
+                replace(window_filename, "{x}", wx);
+                replace(window_filename, "{y}", wy);
+                vsg::write(image, window_filename);
+
+                vsg::info("Written window output to ", window_filename);
+            }
+        }
+    }
 
-    vsg::info("Written output to ", output_filename);
+    if (usingMosaic) VSIUnlink(mosaicFilename.string().c_str());
 
     return 0;
 }
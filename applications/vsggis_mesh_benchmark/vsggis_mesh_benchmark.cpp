@@ -0,0 +1,125 @@
+#include <vsg/all.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <vsgGIS/ellipsoid_utils.h>
+
+// original per vertex path used by TileReader::createECEFTile(), kept here as the reference for timings and accuracy checks
+static void convertPerVertex(const vsg::EllipsoidModel& ellipsoidModel, const vsg::dbox& tile_extents, uint32_t numRows, uint32_t numCols, bool mercator, const vsg::dmat4& worldToLocal, vsg::vec3* vertices)
+{
+    double longitudeOrigin = tile_extents.min.x;
+    double longitudeScale = (tile_extents.max.x - tile_extents.min.x) / double(numCols - 1);
+    double latitudeOrigin = tile_extents.min.y;
+    double latitudeScale = (tile_extents.max.y - tile_extents.min.y) / double(numRows - 1);
+
+    for (uint32_t r = 0; r < numRows; ++r)
+    {
+        for (uint32_t c = 0; c < numCols; ++c)
+        {
+            vsg::dvec3 location(longitudeOrigin + double(c) * longitudeScale, latitudeOrigin + double(r) * latitudeScale, 0.0);
+            vsg::dvec3 latitudeLongitudeAltitude(location.y, location.x, location.z);
+            if (mercator)
+            {
+                double n = 2.0 * vsg::radians(location.y);
+                latitudeLongitudeAltitude.x = vsg::degrees(atan(0.5 * (exp(n) - exp(-n))));
+            }
+
+            auto ecef = ellipsoidModel.convertLatLongAltitudeToECEF(latitudeLongitudeAltitude);
+            vertices[c + r * numCols] = vsg::vec3(worldToLocal * ecef);
+        }
+    }
+}
+
+// batched path, latitudes computed per row and longitudes per column
+static void convertBatched(const vsg::EllipsoidModel& ellipsoidModel, const vsg::dbox& tile_extents, uint32_t numRows, uint32_t numCols, bool mercator, const vsg::dmat4& worldToLocal, vsg::vec3* vertices)
+{
+    double longitudeOrigin = tile_extents.min.x;
+    double longitudeScale = (tile_extents.max.x - tile_extents.min.x) / double(numCols - 1);
+    double latitudeOrigin = tile_extents.min.y;
+    double latitudeScale = (tile_extents.max.y - tile_extents.min.y) / double(numRows - 1);
+
+    std::vector<double> latitudes(numRows);
+    std::vector<double> longitudes(numCols);
+    for (uint32_t r = 0; r < numRows; ++r)
+    {
+        latitudes[r] = latitudeOrigin + double(r) * latitudeScale;
+        if (mercator)
+        {
+            double n = 2.0 * vsg::radians(latitudes[r]);
+            latitudes[r] = vsg::degrees(atan(0.5 * (exp(n) - exp(-n))));
+        }
+    }
+    for (uint32_t c = 0; c < numCols; ++c) longitudes[c] = longitudeOrigin + double(c) * longitudeScale;
+
+    vsgGIS::convertLatLongGridToLocal(ellipsoidModel, latitudes.data(), numRows, longitudes.data(), numCols, 0.0, worldToLocal, vertices);
+}
+
+int main(int argc, char** argv)
+{
+    vsg::CommandLine arguments(&argc, argv);
+
+    auto numTiles = arguments.value<uint32_t>(10000, "--tiles");
+    auto numRows = arguments.value<uint32_t>(32, "--rows");
+    auto numCols = arguments.value<uint32_t>(32, "--cols");
+    auto level = arguments.value<uint32_t>(8, "--level");
+    bool mercator = arguments.read("--mercator");
+
+    if (arguments.errors()) return arguments.writeErrorMessages(std::cerr);
+
+    auto ellipsoidModel = vsg::EllipsoidModel::create();
+
+    // walk a strip of tiles across the globe at the requested level so both paths see a representative spread of latitudes
+    double tileSize = 180.0 / double(1u << level);
+    std::vector<vsg::dbox> tiles;
+    for (uint32_t i = 0; i < numTiles; ++i)
+    {
+        double lon = -180.0 + std::fmod(double(i) * tileSize, 360.0 - tileSize);
+        double lat = -80.0 + std::fmod(double(i) * tileSize * 0.37, 160.0 - tileSize);
+        tiles.push_back(vsg::dbox(vsg::dvec3(lon, lat, 0.0), vsg::dvec3(lon + tileSize, lat + tileSize, 1.0)));
+    }
+
+    std::vector<vsg::dmat4> worldToLocals;
+    for (auto& tile_extents : tiles)
+    {
+        auto center = (tile_extents.min + tile_extents.max) * 0.5;
+        worldToLocals.push_back(vsg::inverse(ellipsoidModel->computeLocalToWorldTransform(vsg::dvec3(center.y, center.x, 0.0))));
+    }
+
+    std::vector<vsg::vec3> reference(numRows * numCols);
+    std::vector<vsg::vec3> batched(numRows * numCols);
+
+    auto time = [&](auto func, std::vector<vsg::vec3>& vertices) {
+        auto start = vsg::clock::now();
+        for (size_t i = 0; i < tiles.size(); ++i)
+        {
+            func(*ellipsoidModel, tiles[i], numRows, numCols, mercator, worldToLocals[i], vertices.data());
+        }
+        return std::chrono::duration<double, std::chrono::microseconds::period>(vsg::clock::now() - start).count() / double(tiles.size());
+    };
+
+    double perVertexTime = time(convertPerVertex, reference);
+    double batchedTime = time(convertBatched, batched);
+
+    // compare the two paths on every tile
+    double maxError = 0.0;
+    for (size_t i = 0; i < tiles.size(); ++i)
+    {
+        convertPerVertex(*ellipsoidModel, tiles[i], numRows, numCols, mercator, worldToLocals[i], reference.data());
+        convertBatched(*ellipsoidModel, tiles[i], numRows, numCols, mercator, worldToLocals[i], batched.data());
+        for (size_t vi = 0; vi < reference.size(); ++vi)
+        {
+            maxError = std::max(maxError, double(vsg::length(reference[vi] - batched[vi])));
+        }
+    }
+
+    std::cout << "tiles = " << numTiles << ", grid = " << numRows << " x " << numCols << ", level = " << level << (mercator ? ", spherical-mercator" : "") << std::endl;
+    std::cout << "per vertex conversion : " << perVertexTime << " us per tile mesh" << std::endl;
+    std::cout << "batched conversion    : " << batchedTime << " us per tile mesh" << std::endl;
+    std::cout << "speed up              : " << (perVertexTime / batchedTime) << "x" << std::endl;
+    std::cout << "max difference        : " << maxError << " m" << std::endl;
+
+    return 0;
+}
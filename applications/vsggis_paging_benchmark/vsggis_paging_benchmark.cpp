@@ -0,0 +1,304 @@
+#include <vsg/all.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <vsgGIS/TileDatabase.h>
+#include <vsgGIS/TileLoadScheduler.h>
+#include <vsgGIS/gdal_utils.h>
+
+// value at fraction through the sorted samples, i.e. 0.99 for the 99th percentile
+static double percentile(const std::vector<double>& sorted, double fraction)
+{
+    if (sorted.empty()) return 0.0;
+    size_t index = std::min(static_cast<size_t>(fraction * double(sorted.size())), sorted.size() - 1);
+    return sorted[index];
+}
+
+static bool supportsDeviceExtension(VkPhysicalDevice physicalDevice, const char* name)
+{
+    uint32_t count = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
+    std::vector<VkExtensionProperties> extensions(count);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, extensions.data());
+    return std::any_of(extensions.begin(), extensions.end(), [&](const VkExtensionProperties& extension) { return std::strcmp(extension.extensionName, name) == 0; });
+}
+
+// bytes the process has allocated from the device local heaps, as reported by VK_EXT_memory_budget
+static uint64_t deviceLocalMemoryUsage(VkPhysicalDevice physicalDevice)
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+    budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    VkPhysicalDeviceMemoryProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    properties.pNext = &budget;
+
+    vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &properties);
+
+    uint64_t usage = 0;
+    for (uint32_t i = 0; i < properties.memoryProperties.memoryHeapCount; ++i)
+    {
+        if ((properties.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0) usage += budget.heapUsage[i];
+    }
+    return usage;
+}
+
+int main(int argc, char** argv)
+{
+    vsgGIS::initGDAL();
+    vsgGIS::init();
+
+    vsg::CommandLine arguments(&argc, argv);
+
+    auto windowTraits = vsg::WindowTraits::create();
+    windowTraits->windowTitle = "vsggis_paging_benchmark";
+    if (arguments.read({"--fullscreen", "--fs"})) windowTraits->fullscreen = true;
+    if (arguments.read({"--window", "-w"}, windowTraits->width, windowTraits->height)) windowTraits->fullscreen = false;
+
+    // don't let vsync cap the frame rate being measured unless asked to
+    if (!arguments.read("--vsync")) windowTraits->swapchainPreferences.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+
+    // camera animation path to play back, i.e. one recorded with vsgviewer, otherwise the camera descends from altitude over --location
+    auto pathFilename = arguments.value<std::string>("", "--path");
+    vsg::dvec3 location(0.0, 0.0, 0.0);
+    arguments.read("--location", location.x, location.y);
+    auto startAltitude = arguments.value<double>(1.0e7, "--start-altitude");
+    auto endAltitude = arguments.value<double>(1.0e3, "--end-altitude");
+    auto duration = arguments.value<double>(30.0, "--duration");
+
+    // advance the path by a fixed time per frame so every run presents the same sequence of views, otherwise the path is played back in real time
+    auto frameTime = arguments.value<double>(0.0, "--frame-time");
+    auto maxFrames = arguments.value<uint64_t>(0, "--frames");
+
+    // per frame samples, and the TileReader's TileLoadStats, written out as CSV and Chrome trace for later comparison
+    auto framesFilename = arguments.value<std::string>("", "--csv");
+    auto statsFilename = arguments.value<std::string>("", "--stats-csv");
+    auto traceFilename = arguments.value<std::string>("", "--trace");
+
+    if (arguments.errors()) return arguments.writeErrorMessages(std::cerr);
+
+    if (argc < 2)
+    {
+        std::cout << "usage:\n    vsggis_paging_benchmark [--path camera.vsgt] [--frame-time 0.016] [--frames n] [--csv frames.csv] [--stats-csv stats.csv] [--trace trace.json] database.vsgt" << std::endl;
+        std::cout << "    vsggis_paging_benchmark [--location latitude longitude] [--start-altitude 1e7] [--end-altitude 1e3] [--duration 30] database.vsgt" << std::endl;
+        return 1;
+    }
+
+    auto options = vsg::Options::create();
+    options->paths = vsg::getEnvPaths("VSG_FILE_PATH");
+
+    vsg::Path databaseFilename = arguments[1];
+    auto database = vsg::read_cast<vsgGIS::TileDatabase>(databaseFilename, options);
+    if (!database || !database->tileReader)
+    {
+        std::cout << "failed to read TileDatabase " << databaseFilename << std::endl;
+        return 1;
+    }
+
+    auto tileReader = database->tileReader;
+    auto ellipsoidModel = database->settings->ellipsoidModel;
+
+    vsg::ref_ptr<vsg::AnimationPath> animationPath;
+    if (!pathFilename.empty())
+    {
+        animationPath = vsg::read_cast<vsg::AnimationPath>(pathFilename, options);
+        if (!animationPath || animationPath->locations.empty())
+        {
+            std::cout << "failed to read animation path " << pathFilename << std::endl;
+            return 1;
+        }
+        duration = animationPath->locations.rbegin()->first - animationPath->locations.begin()->first;
+    }
+
+    auto window = vsg::Window::create(windowTraits);
+    if (!window)
+    {
+        std::cout << "could not create window." << std::endl;
+        return 1;
+    }
+
+    // device memory in use is only reported where the driver supports VK_EXT_memory_budget, which has to be enabled before the device is created
+    VkPhysicalDevice physicalDevice = window->getOrCreatePhysicalDevice()->vk();
+    bool memoryBudget = supportsDeviceExtension(physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (memoryBudget) windowTraits->deviceExtensionNames.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+    auto viewer = vsg::Viewer::create();
+    viewer->addWindow(window);
+    viewer->addEventHandler(vsg::CloseHandler::create(viewer));
+
+    double radius = ellipsoidModel->radiusEquator();
+    auto lookAt = vsg::LookAt::create(vsg::dvec3(0.0, -radius * 3.5, 0.0), vsg::dvec3(0.0, 0.0, 0.0), vsg::dvec3(0.0, 0.0, 1.0));
+
+    double aspectRatio = static_cast<double>(window->extent2D().width) / static_cast<double>(window->extent2D().height);
+    auto perspective = vsg::EllipsoidPerspective::create(lookAt, ellipsoidModel, 30.0, aspectRatio, 0.0005, 0.0);
+    auto camera = vsg::Camera::create(perspective, lookAt, vsg::ViewportState::create(window->extent2D()));
+
+    // position the camera at time t through the path, the scripted descent looks straight down with north up
+    auto positionCamera = [&](double t) {
+        if (animationPath)
+        {
+            lookAt->set(animationPath->computeMatrix(animationPath->locations.begin()->first + t));
+            return;
+        }
+
+        double r = duration > 0.0 ? std::min(t / duration, 1.0) : 1.0;
+        double altitude = startAltitude * std::pow(endAltitude / startAltitude, r);
+        vsg::dvec3 eye = ellipsoidModel->convertLatLongAltitudeToECEF(vsg::dvec3(location.x, location.y, altitude));
+        vsg::dvec3 center = ellipsoidModel->convertLatLongAltitudeToECEF(vsg::dvec3(location.x, location.y, 0.0));
+        vsg::dvec3 north = ellipsoidModel->convertLatLongAltitudeToECEF(vsg::dvec3(std::min(location.x + 0.01, 89.99), location.y, 0.0));
+        lookAt->eye = eye;
+        lookAt->center = center;
+        lookAt->up = vsg::normalize(north - center);
+    };
+    positionCamera(0.0);
+
+    auto commandGraph = vsg::createCommandGraphForView(window, camera, database);
+    viewer->assignRecordAndSubmitTaskAndPresentation({commandGraph});
+    viewer->compile();
+
+    // match the pager's expiry to the value the database's ResourceHints were sized for
+    vsg::ref_ptr<vsg::DatabasePager> databasePager;
+    for (auto& task : viewer->recordAndSubmitTasks)
+    {
+        if (task->databasePager)
+        {
+            databasePager = task->databasePager;
+            databasePager->targetMaxNumPagedLODWithHighResSubgraphs = database->settings->pagerTargetMaxNumPagedLODWithHighResSubgraphs;
+        }
+    }
+
+    struct FrameSample
+    {
+        double time;
+        double frameTime;
+        uint64_t numTilesRead;
+        uint32_t numActiveRequests;
+        uint32_t numPendingFetches;
+        uint32_t numResidentTiles;
+        uint64_t residentTileBytes;
+        uint64_t deviceMemory;
+    };
+    std::vector<FrameSample> samples;
+
+    auto tilesRead = [&]() {
+        std::scoped_lock<std::mutex> lock(tileReader->statsMutex);
+        return tileReader->numTilesRead;
+    };
+
+    uint64_t initialTilesRead = tilesRead();
+
+    auto startTime = vsg::clock::now();
+    auto previousFrameTime = startTime;
+    double pathTime = 0.0;
+
+    while (viewer->advanceToNextFrame())
+    {
+        auto now = vsg::clock::now();
+        double elapsed = std::chrono::duration<double>(now - startTime).count();
+        pathTime = frameTime > 0.0 ? double(samples.size() + 1) * frameTime : elapsed;
+
+        if (pathTime > duration || (maxFrames > 0 && samples.size() >= maxFrames)) break;
+
+        if (!samples.empty())
+        {
+            samples.back().frameTime = std::chrono::duration<double, std::chrono::milliseconds::period>(now - previousFrameTime).count();
+        }
+        previousFrameTime = now;
+
+        viewer->handleEvents();
+
+        positionCamera(pathTime);
+        if (tileReader->loadScheduler) tileReader->loadScheduler->setView(lookAt->transform(), perspective->transform(), pathTime);
+
+        viewer->update();
+        viewer->recordAndSubmit();
+        viewer->present();
+
+        FrameSample sample;
+        sample.time = elapsed;
+        sample.frameTime = 0.0;
+        sample.numTilesRead = tilesRead() - initialTilesRead;
+        sample.numActiveRequests = databasePager ? databasePager->numActiveRequests.load() : 0;
+        sample.numPendingFetches = tileReader->loadScheduler ? static_cast<uint32_t>(tileReader->loadScheduler->numPending()) : 0;
+        {
+            std::scoped_lock<std::mutex> lock(tileReader->statsMutex);
+            sample.numResidentTiles = tileReader->numResidentTiles;
+            sample.residentTileBytes = tileReader->residentTileBytes;
+        }
+        sample.deviceMemory = memoryBudget ? deviceLocalMemoryUsage(physicalDevice) : 0;
+        samples.push_back(sample);
+    }
+
+    // the last frame has no following frame to close its timing
+    if (!samples.empty()) samples.pop_back();
+
+    if (samples.empty())
+    {
+        std::cout << "no frames rendered." << std::endl;
+        return 1;
+    }
+
+    double totalTime = std::chrono::duration<double>(previousFrameTime - startTime).count();
+
+    std::vector<double> frameTimes;
+    uint32_t maxActiveRequests = 0;
+    double totalActiveRequests = 0.0;
+    uint64_t peakDeviceMemory = 0;
+    for (auto& sample : samples)
+    {
+        frameTimes.push_back(sample.frameTime);
+        maxActiveRequests = std::max(maxActiveRequests, sample.numActiveRequests);
+        totalActiveRequests += double(sample.numActiveRequests);
+        peakDeviceMemory = std::max(peakDeviceMemory, sample.deviceMemory);
+    }
+    std::sort(frameTimes.begin(), frameTimes.end());
+
+    auto& last = samples.back();
+    double megabyte = 1024.0 * 1024.0;
+
+    std::cout << databaseFilename << " : " << samples.size() << " frames, " << totalTime << " s" << (animationPath ? (", path " + pathFilename) : std::string(", scripted descent")) << std::endl;
+    std::cout << "frames/sec                 : " << double(samples.size()) / totalTime << std::endl;
+    std::cout << "frame time p50/p90/p99/max : " << percentile(frameTimes, 0.5) << " / " << percentile(frameTimes, 0.9) << " / " << percentile(frameTimes, 0.99) << " / " << frameTimes.back() << " ms" << std::endl;
+    std::cout << "tiles loaded               : " << last.numTilesRead << ", " << double(last.numTilesRead) / totalTime << " tiles/sec" << std::endl;
+    if (databasePager)
+    {
+        std::cout << "pager active requests      : mean " << totalActiveRequests / double(samples.size()) << ", max " << maxActiveRequests << std::endl;
+    }
+    std::cout << "resident tiles             : " << last.numResidentTiles << ", " << double(last.residentTileBytes) / megabyte << " MB, peak " << tileReader->peakNumResidentTiles << " of " << tileReader->numPreallocatedTiles << " preallocated" << std::endl;
+    if (memoryBudget)
+    {
+        std::cout << "device local memory        : " << double(last.deviceMemory) / megabyte << " MB, peak " << double(peakDeviceMemory) / megabyte << " MB" << std::endl;
+    }
+    else
+    {
+        std::cout << "device local memory        : VK_EXT_memory_budget not supported, see resident tiles for the estimate" << std::endl;
+    }
+
+    if (tileReader->uploadBudget)
+    {
+        auto& uploadBudget = *tileReader->uploadBudget;
+        std::cout << "upload budget              : " << double(uploadBudget.bytesPerFrame) / megabyte << " MB/frame, " << uploadBudget.numDeferred.load() << " subtiles deferred, " << double(uploadBudget.numBytes.load()) / megabyte << " MB released" << std::endl;
+    }
+    if (tileReader->loadStats) tileReader->loadStats->print(std::cout);
+
+    if (!framesFilename.empty())
+    {
+        std::ofstream fout(framesFilename);
+        fout << "time,frame_ms,tiles_read,pager_active_requests,pending_fetches,resident_tiles,resident_tile_bytes,device_memory_bytes\n";
+        for (auto& sample : samples)
+        {
+            fout << sample.time << "," << sample.frameTime << "," << sample.numTilesRead << "," << sample.numActiveRequests << "," << sample.numPendingFetches << "," << sample.numResidentTiles << "," << sample.residentTileBytes << "," << sample.deviceMemory << "\n";
+        }
+    }
+
+    if (!statsFilename.empty() && tileReader->loadStats) tileReader->loadStats->writeCSV(statsFilename);
+    if (!traceFilename.empty() && tileReader->loadStats) tileReader->loadStats->writeChromeTrace(traceFilename);
+
+    return 0;
+}
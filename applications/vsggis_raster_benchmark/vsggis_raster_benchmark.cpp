@@ -0,0 +1,200 @@
+#include <vsg/all.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <vsgGIS/gdal_utils.h>
+
+// original byte by byte path used by vsgGIS::copyRasterBandToImage(), kept here as the reference for timings and accuracy checks
+static bool copyByteByByte(GDALRasterBand& band, vsg::Data& image, int component)
+{
+    int dataSize = GDALGetDataTypeSizeBytes(band.GetRasterDataType());
+    int offset = dataSize * component;
+    int stride = image.getLayout().stride;
+
+    int nBlockXSize, nBlockYSize;
+    band.GetBlockSize(&nBlockXSize, &nBlockYSize);
+
+    int nXBlocks = (band.GetXSize() + nBlockXSize - 1) / nBlockXSize;
+    int nYBlocks = (band.GetYSize() + nBlockYSize - 1) / nBlockYSize;
+
+    std::vector<uint8_t> block(dataSize * nBlockXSize * nBlockYSize);
+
+    for (int iYBlock = 0; iYBlock < nYBlocks; iYBlock++)
+    {
+        for (int iXBlock = 0; iXBlock < nXBlocks; iXBlock++)
+        {
+            int nXValid, nYValid;
+            if (band.ReadBlock(iXBlock, iYBlock, block.data()) != CE_None) return false;
+
+            band.GetActualBlockSize(iXBlock, iYBlock, &nXValid, &nYValid);
+
+            for (int iY = 0; iY < nYValid; iY++)
+            {
+                uint8_t* dest_ptr = reinterpret_cast<uint8_t*>(image.dataPointer(iXBlock * nBlockXSize + (iYBlock * nBlockYSize + iY) * image.width())) + offset;
+                uint8_t* source_ptr = block.data() + iY * nBlockXSize * dataSize;
+
+                for (int iX = 0; iX < nXValid; iX++)
+                {
+                    for (int c = 0; c < dataSize; ++c)
+                    {
+                        dest_ptr[c] = *source_ptr;
+                        ++source_ptr;
+                    }
+
+                    dest_ptr += stride;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// write a tiled GeoTIFF with a simple gradient pattern so the benchmark can be run without a large dataset to hand
+static bool createSyntheticDataset(const vsg::Path& filename, int width, int height, int numBands)
+{
+    GDALDriver* driver = GetGDALDriverManager()->GetDriverByName("GTiff");
+    if (!driver) return false;
+
+    char** createOptions = nullptr;
+    createOptions = CSLAddString(createOptions, "TILED=YES");
+    createOptions = CSLAddString(createOptions, "BIGTIFF=IF_SAFER");
+
+    std::shared_ptr<GDALDataset> dataset(driver->Create(filename.string().c_str(), width, height, numBands, GDT_Byte, createOptions), [](GDALDataset* ds) { GDALClose(ds); });
+    CSLDestroy(createOptions);
+    if (!dataset) return false;
+
+    std::vector<uint8_t> row(width);
+    for (int b = 1; b <= numBands; ++b)
+    {
+        GDALRasterBand* band = dataset->GetRasterBand(b);
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x) row[x] = static_cast<uint8_t>(x * b + y);
+            if (band->RasterIO(GF_Write, 0, y, width, 1, row.data(), width, 1, GDT_Byte, 0, 0) != CE_None) return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    vsgGIS::initGDAL();
+
+    vsg::CommandLine arguments(&argc, argv);
+
+    int width = 0, height = 0, numBands = 4;
+    bool create = arguments.read("--create", width, height, numBands);
+    auto cacheSize = arguments.value<int64_t>(0, "--gdal-cache");
+    auto numThreads = arguments.value<uint32_t>(std::max(std::thread::hardware_concurrency(), 1u), "--threads");
+
+    if (arguments.errors()) return arguments.writeErrorMessages(std::cerr);
+
+    if (argc < 2)
+    {
+        std::cout << "usage:\n    vsggis_raster_benchmark input.tif\n    vsggis_raster_benchmark --create width height numBands output.tif" << std::endl;
+        return 1;
+    }
+
+    vsg::Path filename = arguments[1];
+    if (create)
+    {
+        std::cout << "creating " << filename << " " << width << " x " << height << " x " << numBands << std::endl;
+        if (!createSyntheticDataset(filename, width, height, numBands))
+        {
+            std::cout << "failed to create " << filename << std::endl;
+            return 1;
+        }
+    }
+
+    if (cacheSize > 0) GDALSetCacheMax64(cacheSize);
+
+    auto dataset = vsgGIS::openDataSet(filename, GA_ReadOnly);
+    if (!dataset)
+    {
+        std::cout << "failed to open " << filename << std::endl;
+        return 1;
+    }
+
+    width = dataset->GetRasterXSize();
+    height = dataset->GetRasterYSize();
+
+    auto types = vsgGIS::dataTypes(*dataset);
+    int numComponents = std::min(dataset->GetRasterCount(), 4);
+    if (types.size() != 1 || numComponents == 0)
+    {
+        std::cout << "benchmark requires 1 to 4 raster bands of a single data type." << std::endl;
+        return 1;
+    }
+    if (numComponents == 3) numComponents = 4;
+
+    GDALDataType dataType = *types.begin();
+    int numBandsToCopy = std::min(dataset->GetRasterCount(), 4);
+
+    auto reference = vsgGIS::createImage2D(width, height, numComponents, dataType);
+    auto image = vsgGIS::createImage2D(width, height, numComponents, dataType);
+    if (!reference || !image)
+    {
+        std::cout << "unsupported data type " << GDALGetDataTypeName(dataType) << std::endl;
+        return 1;
+    }
+
+    std::cout << filename << " : " << width << " x " << height << " x " << numBandsToCopy << " " << GDALGetDataTypeName(dataType) << ", " << (double(image->dataSize()) / (1024.0 * 1024.0)) << " MB image" << std::endl;
+
+    // the target is filled with a sentinel before each pass so that a copy that fails, or skips part of the image, can't pass on an earlier pass's results
+    auto time = [&](auto func, vsg::Data& target, bool& success) {
+        std::memset(target.dataPointer(), 0xcd, target.dataSize());
+        auto start = vsg::clock::now();
+        success = func();
+        return std::chrono::duration<double, std::chrono::milliseconds::period>(vsg::clock::now() - start).count();
+    };
+
+    auto perBand = [&](auto copy, vsg::Data& target) {
+        return [&, copy]() {
+            bool result = true;
+            for (int b = 0; b < numBandsToCopy; ++b) result = copy(*dataset->GetRasterBand(b + 1), target, b) && result;
+            return result;
+        };
+    };
+
+    auto matches = [&](bool success) { return success && std::memcmp(reference->dataPointer(), image->dataPointer(), image->dataSize()) == 0; };
+
+    std::vector<int> bands;
+    for (int b = 1; b <= numBandsToCopy; ++b) bands.push_back(b);
+
+    // the first pass pulls the file through the OS and GDAL caches so the timed paths see comparable I/O
+    bool success = false;
+    double warmupTime = time(perBand(copyByteByByte, *reference), *reference, success);
+    double byteByByteTime = time(perBand(copyByteByByte, *reference), *reference, success);
+    if (!success)
+    {
+        std::cout << "failed to read reference image from " << filename << std::endl;
+        return 1;
+    }
+
+    double interleaveTime = time(perBand(vsgGIS::copyRasterBandToImageByBlocks, *image), *image, success);
+    bool interleaveMatches = matches(success);
+    double rasterIOTime = time(perBand(vsgGIS::copyRasterBandToImage, *image), *image, success);
+    bool rasterIOMatches = matches(success);
+    double datasetRasterIOTime = time([&]() { return vsgGIS::copyRasterBandsToImage(*dataset, bands, *image); }, *image, success);
+    bool datasetRasterIOMatches = matches(success);
+    double parallelRasterIOTime = time([&]() { return vsgGIS::copyRasterBandsToImage(filename, bands, *image, 0, numThreads); }, *image, success);
+    bool parallelRasterIOMatches = matches(success);
+
+    auto report = [&](const char* name, double ms, bool matches) {
+        std::cout << name << ms << " ms, " << (double(image->dataSize()) / (1024.0 * 1024.0)) / (ms * 0.001) << " MB/s, speed up " << (byteByByteTime / ms) << "x" << (matches ? "" : ", MISMATCH") << std::endl;
+    };
+
+    std::cout << "warm up pass               : " << warmupTime << " ms" << std::endl;
+    report("byte by byte ReadBlock     : ", byteByByteTime, true);
+    report("interleaved ReadBlock      : ", interleaveTime, interleaveMatches);
+    report("per band RasterIO          : ", rasterIOTime, rasterIOMatches);
+    report("dataset RasterIO           : ", datasetRasterIOTime, datasetRasterIOMatches);
+    std::cout << "threads = " << numThreads << std::endl;
+    report("parallel dataset RasterIO  : ", parallelRasterIOTime, parallelRasterIOMatches);
+
+    return (interleaveMatches && rasterIOMatches && datasetRasterIOMatches && parallelRasterIOMatches) ? 0 : 1;
+}
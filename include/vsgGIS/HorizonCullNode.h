@@ -0,0 +1,69 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/Export.h>
+
+#include <vsg/core/Inherit.h>
+#include <vsg/maths/vec3.h>
+#include <vsg/nodes/Node.h>
+
+namespace vsgGIS
+{
+
+    /// culls its child when the child is hidden behind the ellipsoid from the viewpoint, complementing the frustum culling of the PagedLOD or CullGroup it wraps.
+    /// horizonOcclusionPoint is in the ellipsoid's scaled space, ECEF divided by radii, chosen so that it's hidden only when all the child is, see TileBound.
+    /// The viewpoint is taken from the modelview matrix, so the node has to be placed in the ellipsoid's ECEF coordinate frame.
+    class VSGGIS_DECLSPEC HorizonCullNode : public vsg::Inherit<vsg::Node, HorizonCullNode>
+    {
+    public:
+        HorizonCullNode();
+        HorizonCullNode(const vsg::dvec3& in_radii, const vsg::dvec3& in_horizonOcclusionPoint, vsg::ref_ptr<vsg::Node> in_child);
+
+        /// equatorial and polar radii of the ellipsoid as x, y and z scales
+        vsg::dvec3 radii;
+        vsg::dvec3 horizonOcclusionPoint;
+        vsg::ref_ptr<vsg::Node> child;
+
+        /// return true if horizonOcclusionPoint is hidden behind the ellipsoid from eye, in ECEF coordinates
+        bool occluded(const vsg::dvec3& eye) const;
+
+        void traverse(vsg::Visitor& visitor) override
+        {
+            if (child) child->accept(visitor);
+        }
+        void traverse(vsg::ConstVisitor& visitor) const override
+        {
+            if (child) child->accept(visitor);
+        }
+        void traverse(vsg::RecordTraversal& visitor) const override;
+
+        void read(vsg::Input& input) override;
+        void write(vsg::Output& output) const override;
+    };
+
+} // namespace vsgGIS
+
+// Provide the means for the vsg::type_name<class> to get the human readable class name.
+EVSG_type_name(vsgGIS::HorizonCullNode);
@@ -0,0 +1,69 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/Export.h>
+
+#include <vsg/core/Data.h>
+#include <vsg/core/Inherit.h>
+#include <vsg/io/ReaderWriter.h>
+
+namespace vsgGIS
+{
+
+    /// header of the memory mappable .vsgm tile format, a fixed size header followed by the raw data, including any mipmaps, at a 64 byte aligned dataOffset.
+    struct MappedTileHeader
+    {
+        char magic[8] = {'v', 's', 'g', 'G', 'I', 'S', 'm', '\n'};
+        uint32_t version = 1;
+        uint32_t format = 0;
+        uint32_t valueSize = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t depth = 0;
+        uint8_t maxNumMipmaps = 0;
+        uint8_t blockWidth = 1;
+        uint8_t blockHeight = 1;
+        uint8_t blockDepth = 1;
+        uint8_t origin = 0;
+        int8_t imageViewType = -1;
+        uint8_t padding[2] = {0, 0};
+        uint64_t dataOffset = 0;
+        uint64_t dataSize = 0;
+    };
+
+    /// ReaderWriter for .vsgm tiles, images stored so they can be used in place. Reading memory maps the file and returns an Array2D, or Array3D, that views the mapped data directly
+    /// as its storage, so local tiles are read without deserializing and copying them onto the heap. The mapping is private so modifying the returned data doesn't modify the file.
+    /// Writing supports the formats that createImage2D() and compressImage() create, only the image data and layout are stored, not the meta data.
+    class VSGGIS_DECLSPEC MappedTileReaderWriter : public vsg::Inherit<vsg::ReaderWriter, MappedTileReaderWriter>
+    {
+    public:
+        vsg::ref_ptr<vsg::Object> read(const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> options = {}) const override;
+
+        bool write(const vsg::Object* object, const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> options = {}) const override;
+    };
+
+} // namespace vsgGIS
+
+EVSG_type_name(vsgGIS::MappedTileReaderWriter);
@@ -0,0 +1,108 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/Export.h>
+#include <vsgGIS/TileDatabase.h>
+#include <vsgGIS/gdal_utils.h>
+
+#include <vsg/core/Data.h>
+#include <vsg/core/Inherit.h>
+#include <vsg/io/Options.h>
+#include <vsg/io/Path.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace vsgGIS
+{
+
+    /// offline builder of the z/x/y tile pyramid read by a TileDatabase, so that local imagery can be served without network fetches.
+    /// The source rasters are mosaiced and reprojected with GDAL to the settings projection, the tiles of the highest level are read from the reprojected sources
+    /// and each lower level is built by 2x2 downsampling the level below. Tiles of each level are built concurrently on numThreads threads, only tiles that overlap the sources are written.
+    class VSGGIS_DECLSPEC PyramidBuilder : public vsg::Inherit<vsg::Object, PyramidBuilder>
+    {
+    public:
+        PyramidBuilder();
+
+        /// layout of the pyramid, the extents, noX, noY, originTopLeft and projection, "EPSG:3857"/"spherical-mercator" or geographic, follow the TileReader conventions.
+        /// settings->imageLayer is the {z}/{x}/{y} template of the tile files written, i.e. "tiles/{z}/{x}/{y}.vsgb". On success settings->maxLevel is set to the highest level built.
+        vsg::ref_ptr<TileDatabaseSettings> settings;
+
+        /// width and height in pixels of each tile
+        uint32_t tileSize = 256;
+
+        /// highest level to build, 0 selects the level that matches the resolution of the sources, capped at the original settings->maxLevel
+        uint32_t maxLevel = 0;
+
+        /// number of threads building tiles concurrently, each with its own GDALDataset handles
+        uint32_t numThreads = 1;
+
+        /// number of box filtered mipmap levels, including the base level, stored with each tile so the TileDatabase uploads them rather than generating them on the GPU, 0 or 1 stores only the base level.
+        /// The chain stops at the level of minMipmapSize pixels, on success settings->mipmapLevelsHint is set to the number of levels stored.
+        uint32_t mipmapLevels = 0;
+        uint32_t minMipmapSize = 1;
+
+        /// resampling used when reprojecting the sources to the highest level
+        GDALResampleAlg resampleAlg = GRA_Bilinear;
+
+        /// options used to write, and read back, the tiles, set up with a MappedTileReaderWriter so tile templates ending in .vsgm write memory mappable tiles
+        vsg::ref_ptr<vsg::Options> options;
+
+        /// build the pyramid from the source rasters, which must share a data type and have 1 to 4 bands. Return true on success.
+        bool build(const std::vector<vsg::Path>& sources);
+
+        /// number of tiles written by build()
+        std::atomic_uint64_t numTilesWritten{0};
+
+    protected:
+        struct Source;
+        struct TileRange
+        {
+            uint32_t minX = 1, minY = 1, maxX = 0, maxY = 0;
+            bool empty() const { return minX > maxX || minY > maxY; }
+        };
+
+        std::unique_ptr<Source> openSource(const std::vector<vsg::Path>& sources) const;
+
+        // mapping between the settings coordinates, degrees for geographic and the TileReader's scaled degrees for spherical mercator, and the target spatial reference
+        bool mercator() const;
+        vsg::dvec2 toProjected(const vsg::dvec2& coord) const;
+        vsg::dvec2 fromProjected(const vsg::dvec2& coord) const;
+
+        TileRange computeTileRange(const vsg::dbox& bounds, uint32_t level) const;
+        vsg::Path getTilePath(uint32_t x, uint32_t y, uint32_t level) const;
+
+        vsg::ref_ptr<vsg::Data> readTile(Source& source, uint32_t x, uint32_t y, uint32_t level) const;
+        vsg::ref_ptr<vsg::Data> downsampleTile(uint32_t x, uint32_t y, uint32_t level) const;
+        bool writeTile(vsg::ref_ptr<vsg::Data> tile, uint32_t x, uint32_t y, uint32_t level);
+
+        int numComponents = 0;
+        int numBands = 0;
+        GDALDataType dataType = GDT_Unknown;
+        std::string targetWKT;
+    };
+
+} // namespace vsgGIS
@@ -0,0 +1,97 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/Export.h>
+#include <vsgGIS/TileDatabase.h>
+#include <vsgGIS/gdal_utils.h>
+
+#include <vsg/core/Data.h>
+#include <vsg/core/Inherit.h>
+#include <vsg/io/Path.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vsgGIS
+{
+
+    /// tile layer served directly from a GDAL raster, i.e. a GeoTIFF, COG or VRT, rather than from a pre-built tile pyramid. Each tile's window, from the settings' computeTileExtents(),
+    /// is read with RasterIO from the coarsest overview that still matches the tile's resolution, so coarse levels don't read full resolution pixels and COGs only fetch the byte ranges they need.
+    /// Rasters in a different projection to the settings' projection are reprojected on the fly through a warped VRT, which reads through the overviews of the raster.
+    /// GDALDatasets aren't thread safe so each read takes a handle from a pool of datasets, opening another when all are in use by other threads. Thread safe.
+    class VSGGIS_DECLSPEC RasterTileLayer : public vsg::Inherit<vsg::Object, RasterTileLayer>
+    {
+    public:
+        RasterTileLayer(const vsg::Path& in_filename, vsg::ref_ptr<const TileDatabaseSettings> in_settings, uint32_t in_tileSize = 256, GDALResampleAlg in_resampleAlg = GRA_Bilinear);
+        ~RasterTileLayer();
+
+        /// prefix of the TileDatabaseSettings imageLayer and terrainLayer that selects a RasterTileLayer, i.e. "gdal:world.tif" or "gdal:/vsicurl/https://server/cog.tif"
+        static constexpr const char* prefix = "gdal:";
+
+        /// return true if layer is a raster layer, starting with the prefix
+        static bool isRasterLayer(const vsg::Path& layer);
+
+        /// return the raster filename of a raster layer, the layer without its prefix
+        static vsg::Path rasterFilename(const vsg::Path& layer);
+
+        /// read tile x, y at level, tiles that don't overlap the raster are returned with the default values. Return null on failure.
+        vsg::ref_ptr<vsg::Data> read(uint32_t x, uint32_t y, uint32_t level);
+
+        const vsg::Path filename;
+        const vsg::ref_ptr<const TileDatabaseSettings> settings;
+        const uint32_t tileSize;
+        const GDALResampleAlg resampleAlg;
+
+        /// return true if the raster was opened and has 1 to 4 bands of a single supported data type
+        bool valid() const { return numBands > 0; }
+
+        /// number of dataset handles opened, the peak number of threads that have read concurrently
+        size_t numHandles() const;
+
+    protected:
+        struct Handle;
+
+        std::unique_ptr<Handle> openHandle() const;
+        std::unique_ptr<Handle> acquireHandle();
+        void releaseHandle(std::unique_ptr<Handle> handle);
+
+        // index of the coarsest overview of band with no more than decimation source pixels per overview pixel, -1 for the full resolution band
+        int selectOverview(GDALRasterBand& band, double decimation) const;
+
+        int numComponents = 0;
+        int numBands = 0;
+        GDALDataType dataType = GDT_Unknown;
+        std::string targetWKT;
+        bool reproject = false;
+
+        mutable std::mutex _mutex;
+        std::vector<std::unique_ptr<Handle>> _available;
+        size_t _numHandles = 0;
+    };
+
+} // namespace vsgGIS
+
+EVSG_type_name(vsgGIS::RasterTileLayer);
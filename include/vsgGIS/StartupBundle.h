@@ -0,0 +1,58 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/Export.h>
+
+#include <vsg/core/Data.h>
+#include <vsg/core/Inherit.h>
+#include <vsg/state/ShaderStage.h>
+
+namespace vsgGIS
+{
+
+    /// precompiled startup state of a TileDatabase, serialized along with the database's settings so it starts without network I/O or loading shaders, see vsggis --startup-bundle.
+    /// Writing the TileDatabase to a .vsgb file uses the binary serialization so the bundle's tiles and SPIR-V are read back without parsing.
+    class VSGGIS_DECLSPEC StartupBundle : public vsg::Inherit<vsg::Object, StartupBundle>
+    {
+    public:
+        /// SPIR-V compiled shaders of the tile pipeline, only used when the TileReader's gpuTerrainDisplacement and textureArrays select the same pipeline as the bundle was created for
+        bool gpuTerrainDisplacement = false;
+        bool textureArrays = false;
+        vsg::ref_ptr<vsg::ShaderStage> vertexShader;
+        vsg::ref_ptr<vsg::ShaderStage> fragmentShader;
+
+        /// level 0 image and terrain tiles indexed by x + y * noX. Root tiles without an image are paged in once the database is traversed rather than fetched as the database is read,
+        /// except with textureArrays which need all the root tiles up front.
+        vsg::DataList rootImages;
+        vsg::DataList rootTerrains;
+
+        void read(vsg::Input& input) override;
+        void write(vsg::Output& output) const override;
+    };
+
+} // namespace vsgGIS
+
+// Provide the means for the vsg::type_name<class> to get the human readable class name.
+EVSG_type_name(vsgGIS::StartupBundle);
@@ -0,0 +1,195 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/Export.h>
+
+#include <vsg/core/Data.h>
+#include <vsg/core/Inherit.h>
+#include <vsg/io/Path.h>
+#include <vsg/io/ReaderWriter.h>
+
+#include <chrono>
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+namespace vsgGIS
+{
+
+    /// persistent on disk cache of tiles, stored in the memory mappable .vsgm form as <path>/<layer hash>/<z>/<x>/<y>.vsgm so that repeat sessions don't need to refetch remote tiles, nor deserialize them.
+    /// When the total size of the cache exceeds maxSize the least recently used tiles are evicted, tiles written more than expiryTime seconds ago are treated as absent.
+    /// Thread safe, typically used by the TileReader fetch threads.
+    class VSGGIS_DECLSPEC TileCache : public vsg::Inherit<vsg::Object, TileCache>
+    {
+    public:
+        TileCache(const vsg::Path& in_path, uint64_t in_maxSize, double in_expiryTime);
+
+        /// read tile from cache, return null if the tile isn't cached or has expired.
+        vsg::ref_ptr<vsg::Data> read(const vsg::Path& layer, uint32_t x, uint32_t y, uint32_t level);
+
+        /// write tile to cache, evicting least recently used tiles as required to keep within maxSize. Return true on success.
+        bool write(const vsg::Path& layer, uint32_t x, uint32_t y, uint32_t level, vsg::ref_ptr<vsg::Data> data);
+
+        const vsg::Path path;
+        const uint64_t maxSize;
+        const double expiryTime;
+
+        /// total size in bytes of the tiles in the cache
+        uint64_t size() const;
+
+    protected:
+        vsg::Path getTileFilename(const vsg::Path& layer, uint32_t x, uint32_t y, uint32_t level) const;
+
+        void scan();
+        void remove(const vsg::Path& filename);
+        void evict();
+
+        struct Entry
+        {
+            uint64_t size;
+            std::list<vsg::Path>::iterator position;
+            uint64_t generation;
+        };
+
+        mutable std::mutex _mutex;
+        vsg::ref_ptr<vsg::ReaderWriter> _readerWriter;
+        std::list<vsg::Path> _leastRecentlyUsed;
+        std::unordered_map<std::string, Entry> _entries;
+        uint64_t _size = 0;
+        uint64_t _generation = 0;
+    };
+
+    /// in memory cache of decoded tiles, or built tile subgraphs, so that returning to an area after the DatabasePager has expired its tiles doesn't require them to be read and decoded again.
+    /// Objects are keyed by a key string that identifies the layer or kind of object, along with the tile x, y and level.
+    /// When the total size of the cached objects exceeds maxSize the least recently used objects are released. Thread safe.
+    class VSGGIS_DECLSPEC MemoryTileCache : public vsg::Inherit<vsg::Object, MemoryTileCache>
+    {
+    public:
+        explicit MemoryTileCache(uint64_t in_maxSize);
+
+        /// return the cached object, or null if not cached.
+        vsg::ref_ptr<vsg::Object> get(const std::string& key, uint32_t x, uint32_t y, uint32_t level);
+
+        /// remove the object from the cache and return it, or null if not cached.
+        vsg::ref_ptr<vsg::Object> take(const std::string& key, uint32_t x, uint32_t y, uint32_t level);
+
+        /// add object to the cache, size is the object's memory footprint in bytes used to keep the cache within maxSize.
+        void insert(const std::string& key, uint32_t x, uint32_t y, uint32_t level, vsg::ref_ptr<vsg::Object> object, uint64_t size);
+
+        const uint64_t maxSize;
+
+        /// total size in bytes of the objects in the cache
+        uint64_t size() const;
+
+        uint64_t numHits() const;
+        uint64_t numMisses() const;
+
+    protected:
+        struct Key
+        {
+            std::string key;
+            uint32_t x;
+            uint32_t y;
+            uint32_t level;
+
+            bool operator<(const Key& rhs) const { return std::tie(level, x, y, key) < std::tie(rhs.level, rhs.x, rhs.y, rhs.key); }
+        };
+
+        struct Entry
+        {
+            vsg::ref_ptr<vsg::Object> object;
+            uint64_t size;
+            std::list<Key>::iterator position;
+        };
+
+        void evict();
+
+        mutable std::mutex _mutex;
+        std::list<Key> _leastRecentlyUsed;
+        std::map<Key, Entry> _entries;
+        uint64_t _size = 0;
+        uint64_t _numHits = 0;
+        uint64_t _numMisses = 0;
+    };
+
+    /// record of failed tile fetches so that a tile that has failed isn't fetched again each time the pager requests it, but only once its backoff has elapsed.
+    /// The backoff starts at initialDelay seconds and doubles with each consecutive failure of the tile up to maxDelay, once a tile has failed more than maxRetries times
+    /// it's held at maxDelay. A successful fetch clears the tile's record, and records of tiles that are no longer being requested are pruned as the record grows. Thread safe.
+    class VSGGIS_DECLSPEC FetchBackoff : public vsg::Inherit<vsg::Object, FetchBackoff>
+    {
+    public:
+        FetchBackoff(double in_initialDelay, double in_maxDelay, uint32_t in_maxRetries);
+
+        /// return true if the tile may be fetched now, false while it's backing off from a failed fetch.
+        bool ready(const std::string& layer, uint32_t x, uint32_t y, uint32_t level);
+
+        /// record the result of a fetch of the tile, return the time in seconds before the tile may be fetched again, 0.0 if successful.
+        double record(const std::string& layer, uint32_t x, uint32_t y, uint32_t level, bool success);
+
+        const double initialDelay;
+        const double maxDelay;
+        const uint32_t maxRetries;
+
+        /// number of tiles currently recorded as failed
+        size_t numFailedTiles() const;
+
+        /// number of fetches skipped as the tile was backing off
+        uint64_t numSkipped() const;
+
+    protected:
+        // drop the records of tiles whose backoff elapsed more than maxDelay ago, once there are at least _pruneSize records
+        void prune();
+
+        struct Key
+        {
+            std::string layer;
+            uint32_t x;
+            uint32_t y;
+            uint32_t level;
+
+            bool operator<(const Key& rhs) const { return std::tie(level, x, y, layer) < std::tie(rhs.level, rhs.x, rhs.y, rhs.layer); }
+        };
+
+        struct Entry
+        {
+            std::chrono::steady_clock::time_point retryTime;
+            uint32_t numFailures = 0;
+        };
+
+        mutable std::mutex _mutex;
+        std::map<Key, Entry> _entries;
+        uint64_t _numSkipped = 0;
+
+        static constexpr size_t minPruneSize = 1024;
+        size_t _pruneSize = minPruneSize;
+    };
+
+} // namespace vsgGIS
+
+EVSG_type_name(vsgGIS::TileCache);
+EVSG_type_name(vsgGIS::MemoryTileCache);
+EVSG_type_name(vsgGIS::FetchBackoff);
@@ -0,0 +1,116 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/Export.h>
+
+#include <vsg/core/Array.h>
+#include <vsg/core/Array2D.h>
+#include <vsg/core/Array3D.h>
+#include <vsg/core/Inherit.h>
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace vsgGIS
+{
+
+    /// pool of fixed size memory blocks that the per tile geometry and image arrays are created in, so the memory of tiles expired by the DatabasePager is recycled for new tiles
+    /// rather than freed and reallocated. Blocks are pooled by their size in bytes, a block is free for reuse once it's only referenced by the pool.
+    /// The pool retains at most maxSize bytes of blocks, a maxSize of 0 is unlimited, free blocks of other sizes are released to make room before allocating unpooled blocks. Thread safe.
+    class VSGGIS_DECLSPEC TileDataPool : public vsg::Inherit<vsg::Object, TileDataPool>
+    {
+    public:
+        explicit TileDataPool(uint64_t in_maxSize);
+
+        /// return a block of size bytes, reusing a free block of that size when available
+        vsg::ref_ptr<vsg::Data> acquire(size_t size);
+
+        /// release the free blocks, return the number of bytes released
+        uint64_t trim();
+
+        const uint64_t maxSize;
+
+        struct Occupancy
+        {
+            size_t blockSize = 0;
+            uint32_t numBlocks = 0;
+            uint32_t numInUse = 0;
+        };
+
+        /// occupancy of the pool of each block size
+        std::vector<Occupancy> occupancy() const;
+
+        /// total size in bytes of the pooled blocks
+        uint64_t size() const;
+
+        uint64_t numAcquired() const;
+        uint64_t numReused() const;
+        uint64_t numUnpooled() const;
+
+    protected:
+        uint64_t release(size_t required, size_t exclude);
+
+        struct Pool
+        {
+            std::vector<vsg::ref_ptr<vsg::Data>> blocks;
+            size_t next = 0;
+        };
+
+        mutable std::mutex _mutex;
+        std::map<size_t, Pool> _pools;
+        uint64_t _size = 0;
+        uint64_t _numAcquired = 0;
+        uint64_t _numReused = 0;
+        uint64_t _numUnpooled = 0;
+    };
+
+    /// create an array in a block from pool, or allocate it as normal when pool is null
+    template<typename T>
+    vsg::ref_ptr<vsg::Array<T>> createArray(TileDataPool* pool, uint32_t numElements, vsg::Data::Layout layout = {})
+    {
+        if (!pool) return vsg::Array<T>::create(numElements, layout);
+        return vsg::Array<T>::create(pool->acquire(sizeof(T) * numElements), 0, sizeof(T), numElements, layout);
+    }
+
+    /// create a 2D array in a block from pool, or allocate it as normal when pool is null
+    template<typename T>
+    vsg::ref_ptr<vsg::Array2D<T>> createArray2D(TileDataPool* pool, uint32_t width, uint32_t height, vsg::Data::Layout layout = {})
+    {
+        if (!pool) return vsg::Array2D<T>::create(width, height, layout);
+        return vsg::Array2D<T>::create(pool->acquire(sizeof(T) * width * height), 0, sizeof(T), width, height, layout);
+    }
+
+    /// create a 3D array in a block from pool, or allocate it as normal when pool is null
+    template<typename T>
+    vsg::ref_ptr<vsg::Array3D<T>> createArray3D(TileDataPool* pool, uint32_t width, uint32_t height, uint32_t depth, vsg::Data::Layout layout = {})
+    {
+        if (!pool) return vsg::Array3D<T>::create(width, height, depth, layout);
+        return vsg::Array3D<T>::create(pool->acquire(sizeof(T) * width * height * depth), 0, sizeof(T), width, height, depth, layout);
+    }
+
+} // namespace vsgGIS
+
+EVSG_type_name(vsgGIS::TileDataPool);
@@ -1,6 +1,12 @@
 #pragma once
 
 #include <vsgGIS/Export.h>
+#include <vsgGIS/StartupBundle.h>
+#include <vsgGIS/TileCache.h>
+#include <vsgGIS/TileDataPool.h>
+#include <vsgGIS/TileLoadScheduler.h>
+#include <vsgGIS/TileLoadStats.h>
+#include <vsgGIS/TileUploadBudget.h>
 
 #include <vsg/all.h>
 
@@ -16,6 +22,16 @@ namespace vsgGIS
         void read(vsg::Input& input) override;
         void write(vsg::Output& output) const override;
 
+        // layout of the settings written by a TileDatabase, version 0 databases only hold the fields read by read()
+        static constexpr uint32_t formatVersion = 1;
+
+        // read/write of the fields added since version 0, written after the settings object by the TileDatabase
+        void readVersionedFields(vsg::Input& input, uint32_t version);
+        void writeVersionedFields(vsg::Output& output) const;
+
+        /// compute the extents, in the units of the extents member, of tile x, y at the specified level
+        vsg::dbox computeTileExtents(uint32_t x, uint32_t y, uint32_t level) const;
+
         // defaults for readymap
         vsg::dbox extents = {{-180.0, -90.0, 0.0}, {180.0, 90.0, 1.0}};
         uint32_t noX = 2;
@@ -27,17 +43,109 @@ namespace vsgGIS
         std::string projection;
         vsg::ref_ptr<vsg::EllipsoidModel> ellipsoidModel = vsg::EllipsoidModel::create();
 
+        // {z}/{x}/{y} templates of the tile files or URLs, or a "gdal:" prefixed raster read in tiles of rasterTileSize pixels
         vsg::Path imageLayer;
         vsg::Path terrainLayer;
+        uint32_t rasterTileSize = 256;
         uint32_t mipmapLevelsHint = 16;
+
+        // generate the imageLayer mipmaps on the loading thread rather than the GPU
+        bool cpuMipmaps = false;
+
+        // smallest mipmap level of the imageLayer tiles, 1 keeps the full chain
+        uint32_t minMipmapSize = 1;
+
+        // block compress the imageLayer tiles, "BC1" or "BC3", empty uploads tiles as read
+        std::string textureCompression;
+
+        // batch the textures of tiles loaded together into shared texture arrays, not supported with textureCompression
+        bool textureArrays = false;
+
+        // displace the ECEF tiles by the terrainLayer heights in the vertex shader rather than on the CPU
+        bool gpuTerrainDisplacement = false;
+
+        // number of threads fetching tiles, 0 reads tiles on the calling thread
+        uint32_t numFetchThreads = 4;
+
+        // fetch the tiles most visible to the camera first, prefetching prefetchTime seconds ahead and cancelling tiles below cancelScreenHeightRatio
+        bool prioritizedLoading = false;
+        double prefetchTime = 0.0;
+        double cancelScreenHeightRatio = 0.0;
+
+        // failed remote tiles are refetched by the pager fetchRetries times after a backoff doubling from fetchRetryDelay, then every fetchRetryMaxDelay seconds, both 0 refetches on every request
+        uint32_t fetchRetries = 0;
+        double fetchRetryDelay = 0.0;
+        double fetchRetryMaxDelay = 60.0;
+
+        // fill subtiles that can't be fetched from their parent tile rather than discarding all 4
+        bool fillMissingSubtiles = false;
+
+        // draw subtiles with their parent's texture and heights while they load, not supported with textureArrays
+        bool incrementalRefinement = false;
+
+        // size ECEF tile grids from their extents, with skirts of skirtRatio times the tile size
+        bool adaptiveGrid = false;
+        double gridMaxAngle = 1.0;
+        uint32_t minGridSegments = 16;
+        uint32_t maxGridSegments = 64;
+        double skirtRatio = 0.02;
+
+        // cull tiles hidden behind the ellipsoid
+        bool horizonCulling = false;
+
+        // on disk cache of fetched tiles, disabled when tileCachePath is empty, 0 sizes and times are unlimited
+        vsg::Path tileCachePath;
+        uint64_t tileCacheMaxSize = 1024 * 1024 * 1024;
+        double tileCacheExpiryTime = 0.0;
+
+        // in memory cache of decoded tiles, and optionally built subgraphs, disabled when memoryCacheMaxSize is 0
+        uint64_t memoryCacheMaxSize = 0;
+        bool memoryCacheSubgraphs = false;
+
+        // bytes of per tile arrays retained for reuse, 0 disables pooling
+        uint64_t tileDataPoolMaxSize = 0;
+
+        // bytes of new tiles released to the DatabasePager each frame, 0 is unlimited
+        uint64_t uploadBytesPerFrame = 0;
+
+        // number of load stage timings recorded as trace events, 0 only collects the histograms
+        uint32_t loadStatsTraceEvents = 0;
+
+        // sizing of the Vulkan resources preallocated via the root's ResourceHints, pagerTargetMaxNumPagedLODWithHighResSubgraphs should match the viewer's DatabasePager
+        uint32_t pagerTargetMaxNumPagedLODWithHighResSubgraphs = 1500;
+        uint32_t maxResidentTiles = 0;
+        uint64_t residentMemoryBudget = 0;
+    };
+
+    // bound of a tile computed from its grid and height range as the tile's mesh is generated, attached to the tile as its "TileBound" object.
+    // The horizonOcclusionPoint is in the ellipsoid's scaled space, ECEF divided by the ellipsoid's radii, and is hidden behind the ellipsoid from a viewpoint only when the whole of the tile is,
+    // it is only valid when hasHorizonOcclusionPoint is true as tiles that wrap too far around the ellipsoid can't be represented by a single point.
+    class VSGGIS_DECLSPEC TileBound : public vsg::Inherit<vsg::Object, TileBound>
+    {
+    public:
+        vsg::dsphere sphere;
+        vsg::dvec3 horizonOcclusionPoint;
+        bool hasHorizonOcclusionPoint = false;
     };
 
+    class RasterTileLayer;
+    class TileReader;
+
     class VSGGIS_DECLSPEC TileDatabase : public vsg::Inherit<vsg::Node, TileDatabase>
     {
     public:
+        // the TileDatabaseSettings::formatVersion is held as the "SettingsVersion" user value, read and written with the Node
+        TileDatabase();
+
         vsg::ref_ptr<TileDatabaseSettings> settings;
         vsg::ref_ptr<vsg::Node> child;
 
+        // TileReader set up by readDatabase(), provides access to its loadScheduler and stats
+        vsg::ref_ptr<TileReader> tileReader;
+
+        // optional precompiled shaders and root tiles used by readDatabase() in place of reading shaders and fetching the root tiles, see TileReader::createStartupBundle()
+        vsg::ref_ptr<StartupBundle> startupBundle;
+
         template<class N, class V>
         static void t_traverse(N& node, V& visitor)
         {
@@ -46,7 +154,7 @@ namespace vsgGIS
 
         void traverse(vsg::Visitor& visitor) override { t_traverse(*this, visitor); }
         void traverse(vsg::ConstVisitor& visitor) const override { t_traverse(*this, visitor); }
-        void traverse(vsg::RecordTraversal& visitor) const override { t_traverse(*this, visitor); }
+        void traverse(vsg::RecordTraversal& visitor) const override;
 
         // read/write of TileReader settings
         void read(vsg::Input& input) override;
@@ -60,13 +168,19 @@ namespace vsgGIS
     public:
         vsg::ref_ptr<TileDatabaseSettings> settings;
 
-        // read/write of TileReader settings
+        // read/write of TileReader settings, only the version 0 fields as the TileReader has no settings version, use the TileDatabase to read/write all the settings
         void read(vsg::Input& input) override;
         void write(vsg::Output& output) const override;
 
+        // precompiled shaders and root tiles used by init() and read_root(), set before calling init()
+        vsg::ref_ptr<StartupBundle> startupBundle;
+
         // initialize data structures
         void init(vsg::ref_ptr<const vsg::Options> options);
 
+        // create a StartupBundle with the SPIR-V of the initialized pipeline's shaders, and when includeRootTiles is set the fetched level 0 tiles
+        vsg::ref_ptr<StartupBundle> createStartupBundle(bool includeRootTiles, vsg::ref_ptr<const vsg::Options> options = {}) const;
+
         // read the tile
         vsg::ref_ptr<vsg::Object> read(const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> options = {}) const override;
 
@@ -75,29 +189,182 @@ namespace vsgGIS
         mutable uint64_t numTilesRead{0};
         mutable double totalTimeReadingTiles{0.0};
 
+        // telemetry of the tiles resident in memory, compare with numPreallocatedTiles to check the ResourceHints sizing
+        mutable uint32_t numResidentTiles{0};
+        mutable uint32_t peakNumResidentTiles{0};
+        mutable uint64_t residentTileBytes{0};
+        mutable uint32_t numPreallocatedTiles{0};
+
+        // called as tiles are created and destroyed to maintain the resident tile telemetry
+        void tileCreated(uint64_t size) const;
+        void tileReleased(uint64_t size) const;
+
+        // pool of the per tile arrays, set up by init() when settings->tileDataPoolMaxSize > 0, use TileDataPool::occupancy() etc. for its stats
+        vsg::ref_ptr<TileDataPool> tileDataPool;
+
+        // scheduler the fetches are run on in place of the fetchThreads, set up by init() when settings->prioritizedLoading is enabled and settings->numFetchThreads > 0.
+        // Call loadScheduler->setView() each frame with the camera's view and projection matrices so requests are prioritized against the current view.
+        vsg::ref_ptr<TileLoadScheduler> loadScheduler;
+
+        // per stage timings and counters of the tile loading pipeline, set up by init() with settings->loadStatsTraceEvents trace events
+        vsg::ref_ptr<TileLoadStats> loadStats;
+
+        // budget read_subtile() waits on before returning newly built tiles, set up by init() when settings->uploadBytesPerFrame > 0, the TileDatabase advances its frames during the record traversal
+        vsg::ref_ptr<TileUploadBudget> uploadBudget;
+
     protected:
+        struct FetchTile;
+        struct ParentTile;
+
+        // fetch the tile of layer on the loadScheduler or fetchThreads, or on the calling thread when neither are set up, bound is the ECEF bound used to prioritize the fetch
+        vsg::ref_ptr<FetchTile> fetchTile(const vsg::Path& layer, uint32_t x, uint32_t y, uint32_t level, const vsg::dsphere& bound, bool prefetch, vsg::ref_ptr<const vsg::Options> options) const;
+
         vsg::dvec3 computeLatitudeLongitudeAltitude(const vsg::dvec3& src) const;
         vsg::dbox computeTileExtents(uint32_t x, uint32_t y, uint32_t level) const;
         vsg::Path getTilePath(const vsg::Path& src, uint32_t x, uint32_t y, uint32_t level) const;
 
+        // ECEF bound of the tile at sea level, used to prioritize its fetches
+        vsg::dsphere computeTileBound(uint32_t x, uint32_t y, uint32_t level) const;
+
+        // wrap the tile in the PagedLOD that pages in its subtiles, or a CullGroup at the maxLevel, culled behind the horizon when enabled
+        vsg::ref_ptr<vsg::Node> createTileLOD(vsg::ref_ptr<vsg::Node> tile, uint32_t x, uint32_t y, uint32_t lod, vsg::ref_ptr<const vsg::Options> options) const;
+
+        // options of the PagedLOD that pages in the tile's subtiles, with settings->incrementalRefinement a copy of options holding the tile's ParentTile
+        vsg::ref_ptr<const vsg::Options> createSubtileOptions(vsg::Node& tile, vsg::ref_ptr<const vsg::Options> options) const;
+
+        // return true when the subtiles of the tile should be prefetched as the camera will need them within the loadScheduler's prefetchTime
+        bool prefetchNeeded(const vsg::Node& tile, uint32_t x, uint32_t y, uint32_t lod) const;
+
+        // wrap node in a HorizonCullNode when settings->horizonCulling is enabled and the tileBound has a horizon occlusion point, otherwise return node
+        vsg::ref_ptr<vsg::Node> cullBehindHorizon(vsg::ref_ptr<vsg::Node> node, const TileBound* tileBound) const;
+
         vsg::ref_ptr<vsg::Object> read_root(vsg::ref_ptr<const vsg::Options> options = {}) const;
         vsg::ref_ptr<vsg::Object> read_subtile(uint32_t x, uint32_t y, uint32_t lod, vsg::ref_ptr<const vsg::Options> options = {}) const;
 
-        vsg::ref_ptr<vsg::Node> createTile(const vsg::dbox& tile_extents, vsg::ref_ptr<vsg::Data> sourceData) const;
-        vsg::ref_ptr<vsg::Node> createECEFTile(const vsg::dbox& tile_extents, vsg::ref_ptr<vsg::Data> sourceData) const;
+        // with settings->incrementalRefinement the subtiles of tile x, y, lod are first read as placeholders drawn with the parentTile's texture, each replaced by the tile read by read_tile() once it's loaded
+        vsg::ref_ptr<vsg::Object> read_placeholders(uint32_t x, uint32_t y, uint32_t lod, const ParentTile& parentTile, vsg::ref_ptr<const vsg::Options> options) const;
+        vsg::ref_ptr<vsg::Object> read_tile(uint32_t x, uint32_t y, uint32_t lod, vsg::ref_ptr<const vsg::Options> options) const;
+
+        // fetch the subtiles of the tiles at level lod into the tile caches ahead of the pager requesting them
+        void prefetchSubtiles(const std::vector<std::pair<uint32_t, uint32_t>>& tiles, uint32_t lod, vsg::ref_ptr<const vsg::Options> options) const;
+
+        // when textureLayer is 0 or more the tile's textures are provided by a texture array bound by a parent StateGroup, see createTextureArrays()
+        vsg::ref_ptr<vsg::Node> createTile(const vsg::dbox& tile_extents, vsg::ref_ptr<vsg::Data> sourceData, vsg::ref_ptr<vsg::Data> terrainData = {}, int32_t textureLayer = -1) const;
+        // when parentTile is set the tile is a placeholder drawn with its region of the parent's texture and sourceData is unused, see read_placeholders()
+        vsg::ref_ptr<vsg::Node> createECEFTile(const vsg::dbox& tile_extents, vsg::ref_ptr<vsg::Data> sourceData, vsg::ref_ptr<vsg::Data> terrainData = {}, int32_t textureLayer = -1, const ParentTile* parentTile = nullptr) const;
         vsg::ref_ptr<vsg::Node> createTextureQuad(const vsg::dbox& tile_extents, vsg::ref_ptr<vsg::Data> sourceData) const;
 
         vsg::ref_ptr<vsg::StateGroup> createRoot() const;
 
+        // number of tiles the ResourceHints should preallocate Vulkan resources for, based on the tiles in the database, the pager's expiry policy and the memory budget
+        uint32_t computeMaxResidentTiles(uint64_t bytesPerTile) const;
+
+        // compress the image data to the textureCompressionFormat, or generate its mipmaps when settings->cpuMipmaps is set, otherwise return it unchanged
+        vsg::ref_ptr<vsg::Data> prepareTexture(vsg::ref_ptr<vsg::Data> textureData) const;
+
+        // sample the single channel terrainData at each vertex of a numRows x numCols grid, return false if the terrainData format isn't supported
+        bool sampleHeights(const vsg::Data& terrainData, uint32_t numRows, uint32_t numCols, std::vector<float>& heights) const;
+
+        // convert the single channel terrainData to a float height texture with the same origin as the image data, return null if the terrainData format isn't supported
+        vsg::ref_ptr<vsg::Data> createHeightTexture(const vsg::Data& terrainData, vsg::Origin origin) const;
+
+        struct TextureArrayLayer
+        {
+            vsg::ref_ptr<vsg::StateGroup> stateGroup;
+            int32_t layer = -1;
+        };
+
+        // pack the images, and heights when displacing on the GPU, into texture arrays returning the StateGroups that bind them, and the StateGroup and layer assigned to each tile.
+        // Tiles with a null stateGroup couldn't be packed and should be skipped.
+        std::vector<vsg::ref_ptr<vsg::StateGroup>> createTextureArrays(const vsg::DataList& images, const vsg::DataList& terrains, std::vector<TextureArrayLayer>& layers) const;
+
+        // texture array layers and tiles of the 4 subtiles of a tile, in the order they're read, cached as a whole when batching textures
+        struct TextureArrayBatch;
+
+        // create the subgraph of the batch's subtiles of tile x, y, lod, with StateGroups sharing the batch's texture array bindings and fresh PagedLODs for the subtiles
+        vsg::ref_ptr<vsg::Group> createBatchGroup(const TextureArrayBatch& batch, uint32_t x, uint32_t y, uint32_t lod, vsg::ref_ptr<const vsg::Options> options) const;
+
+        // get the flat vertices and normals shared by all ECEF tiles with the same latitude range and longitude width, used when displacing the terrain on the GPU
+        vsg::ref_ptr<vsg::Commands> getSharedGrid(const vsg::dbox& tile_extents, const std::vector<double>& latitudes, const std::vector<double>& longitudes, double centerLatitude, double centerLongitude) const;
+
         vsg::ref_ptr<vsg::DescriptorSetLayout> descriptorSetLayout;
         vsg::ref_ptr<vsg::PipelineLayout> pipelineLayout;
         vsg::ref_ptr<vsg::Sampler> sampler;
         vsg::ref_ptr<vsg::GraphicsPipeline> graphicsPipeline;
+
+        // block compressed format set up by init() from settings->textureCompression
+        VkFormat textureCompressionFormat = VK_FORMAT_UNDEFINED;
+
+        // set up by init() from settings->textureArrays
+        bool textureArrays = false;
+
+        // set up by init() from settings->incrementalRefinement
+        bool incrementalRefinement = false;
+
+        // threads used to fetch tiles concurrently with mesh construction, set up by init() when settings->numFetchThreads > 0
+        vsg::ref_ptr<vsg::OperationThreads> fetchThreads;
+
+        // on disk cache checked before fetching tiles, set up by init() when settings->tileCachePath is set
+        vsg::ref_ptr<TileCache> tileCache;
+
+        // in memory cache checked before the on disk cache, set up by init() when settings->memoryCacheMaxSize > 0
+        vsg::ref_ptr<MemoryTileCache> memoryCache;
+
+        // layers read directly from rasters, set up by init() when settings->imageLayer or settings->terrainLayer has the RasterTileLayer::prefix
+        vsg::ref_ptr<RasterTileLayer> imageRasterLayer;
+        vsg::ref_ptr<RasterTileLayer> terrainRasterLayer;
+
+        // record of failed fetches used to back off from refetching them, set up by init() when settings->fetchRetries > 0 or settings->fetchRetryDelay > 0.0
+        vsg::ref_ptr<FetchBackoff> fetchBackoff;
+
+        // the images and terrain of subtiles fetched along with a sibling that is backing off, taken by the fetch when the subtiles are requested again, set up by init() with a fetchBackoff
+        vsg::ref_ptr<MemoryTileCache> heldSubtiles;
+        static constexpr uint64_t heldSubtilesMaxSize = 64 * 1024 * 1024;
+
+        // grid dimensions of an ECEF tile mesh, with the texcoords, indices and draw command shared by all ECEF tiles of that resolution, only the vertices are created per tile
+        struct TileGrid
+        {
+            uint32_t numRows = 32;
+            uint32_t numCols = 32;
+            vsg::ref_ptr<vsg::BindVertexBuffers> bindTexCoordsTopLeft;
+            vsg::ref_ptr<vsg::BindVertexBuffers> bindTexCoordsBottomLeft;
+            vsg::ref_ptr<vsg::BindIndexBuffer> bindIndexBuffer;
+            vsg::ref_ptr<vsg::DrawIndexed> drawIndexed;
+
+            // grid vertices around the edge, duplicated after the grid's vertices as the bottom of the skirts with settings->adaptiveGrid
+            std::vector<uint32_t> perimeter;
+
+            // texcoord offsets to the neighbours of the odd edge vertices, with GPU displacement their heights are interpolated when matching a coarser neighbour
+            vsg::ref_ptr<vsg::vec2Array> edgeOffsets;
+            vsg::ref_ptr<vsg::BindVertexBuffers> bindEdgeOffsets;
+            vsg::ref_ptr<vsg::BindVertexBuffers> bindNoEdgeOffsets;
+
+            uint32_t numVertices() const { return numRows * numCols + static_cast<uint32_t>(perimeter.size()); }
+        };
+
+        // grids keyed by the number of quads along each edge, set up by init() for each resolution selectGrid() can return
+        std::map<uint32_t, TileGrid> tileGrids;
+
+        // number of quads along each edge of tiles with extents of span, in the units of the extents
+        uint32_t computeGridSegments(double span) const;
+
+        // grid for the tile with tile_extents, and whether its edges need matching to the coarser grid of the level above, which is never itself matched
+        const TileGrid& selectGrid(const vsg::dbox& tile_extents, bool* matchParentEdges = nullptr) const;
+
+        // state used when settings->gpuTerrainDisplacement is enabled, tiles without terrain data use the flatHeightTexture
+        bool gpuTerrainDisplacement = false;
+        vsg::ref_ptr<vsg::Sampler> heightSampler;
+        vsg::ref_ptr<vsg::DescriptorImage> flatHeightTexture;
+
+        using GridKey = std::tuple<double, double, double>;
+        mutable std::mutex sharedGridsMutex;
+        mutable std::map<GridKey, vsg::ref_ptr<vsg::Commands>> sharedGrids;
     };
 
 } // namespace vsgGIS
 
 // Provide the means for the vsg::type_name<class> to get the human readable class name.
 EVSG_type_name(vsgGIS::TileDatabaseSettings);
+EVSG_type_name(vsgGIS::TileBound);
 EVSG_type_name(vsgGIS::TileDatabase);
 EVSG_type_name(vsgGIS::TileReader);
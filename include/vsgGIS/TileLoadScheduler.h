@@ -0,0 +1,130 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/Export.h>
+
+#include <vsg/core/Inherit.h>
+#include <vsg/maths/mat4.h>
+#include <vsg/maths/sphere.h>
+#include <vsg/threading/OperationThreads.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vsgGIS
+{
+
+    /// tile load run by the TileLoadScheduler, bound is the world coordinate bound of the tile that the request's priority is computed from.
+    /// Requests with a bound radius of 0 don't depend on the view, they are run ahead of the view dependent requests, coarsest level first, and are never cancelled.
+    /// cancel() is called in place of run() when the request is dropped as stale, so implementations must release anyone waiting on the request.
+    class VSGGIS_DECLSPEC TileRequest : public vsg::Inherit<vsg::Operation, TileRequest>
+    {
+    public:
+        vsg::dsphere bound;
+        uint32_t level = 0;
+
+        /// speculative request ahead of the camera's motion, ranked below requests of the same priority and never waited on
+        bool prefetch = false;
+
+        virtual void cancel() {}
+    };
+
+    /// runs TileRequests on its own threads, each thread taking the pending request with the highest priority at the time it becomes free rather than the oldest.
+    /// The pending requests are held in a priority heap that is re-ranked, and stale requests cancelled, by each setView().
+    /// Priority is the screen height ratio of the request's bound weighted towards the centre of the view, taking the better of the current viewpoint and the viewpoint
+    /// predicted prefetchTime seconds ahead along the camera's motion. Requests whose bound is below cancelScreenHeightRatio at both viewpoints are cancelled,
+    /// a cancelScreenHeightRatio of 0 never cancels. Until setView() is called requests are run coarsest level first, then in the order they were added. Thread safe.
+    class VSGGIS_DECLSPEC TileLoadScheduler : public vsg::Inherit<vsg::Object, TileLoadScheduler>
+    {
+    public:
+        TileLoadScheduler(uint32_t numThreads, double in_prefetchTime = 0.0, double in_cancelScreenHeightRatio = 0.0);
+        ~TileLoadScheduler();
+
+        /// set the camera's world to eye viewMatrix and projectionMatrix, typically from Camera::viewMatrix->transform() and Camera::projectionMatrix->transform() once per frame,
+        /// time is in seconds and successive calls are used to estimate the camera's velocity for prefetching.
+        void setView(const vsg::dmat4& viewMatrix, const vsg::dmat4& projectionMatrix, double time);
+
+        /// add request to the pending requests
+        void add(vsg::ref_ptr<TileRequest> request);
+
+        /// stop the threads and cancel the pending requests, called by the destructor
+        void stop();
+
+        /// screen height ratio of bound from the current viewpoint, and from the viewpoint predicted prefetchTime ahead, 0.0 if setView() hasn't been called
+        double screenHeightRatio(const vsg::dsphere& bound) const;
+        double predictedScreenHeightRatio(const vsg::dsphere& bound) const;
+
+        const double prefetchTime;
+        const double cancelScreenHeightRatio;
+
+        /// number of requests pending
+        size_t numPending() const;
+
+        std::atomic_uint64_t numCompleted{0};
+        std::atomic_uint64_t numCancelled{0};
+        std::atomic_uint64_t numPrefetched{0};
+
+    protected:
+        struct View
+        {
+            bool valid = false;
+            vsg::dvec3 eye;
+            vsg::dvec3 direction;
+            vsg::dvec3 velocity;
+            double projectionScale = 1.0;
+            double time = 0.0;
+        };
+
+        double _screenHeightRatio(const View& view, const vsg::dsphere& bound, const vsg::dvec3& eye) const;
+        double _priority(const View& view, const TileRequest& request, bool& stale) const;
+        void _run();
+
+        struct Pending
+        {
+            double priority;
+            uint64_t sequence;
+            vsg::ref_ptr<TileRequest> request;
+
+            // heap order, ties go to the oldest request
+            bool operator<(const Pending& rhs) const { return priority < rhs.priority || (priority == rhs.priority && sequence > rhs.sequence); }
+        };
+
+        mutable std::mutex _mutex;
+        std::condition_variable _condition;
+        View _view;
+        std::vector<Pending> _pending;
+        uint64_t _sequence = 0;
+        std::vector<std::thread> _threads;
+        bool _active = true;
+    };
+
+} // namespace vsgGIS
+
+// Provide the means for the vsg::type_name<class> to get the human readable class name.
+EVSG_type_name(vsgGIS::TileRequest);
+EVSG_type_name(vsgGIS::TileLoadScheduler);
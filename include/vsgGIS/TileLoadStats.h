@@ -0,0 +1,149 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/Export.h>
+
+#include <vsg/core/Inherit.h>
+#include <vsg/io/Path.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+namespace vsgGIS
+{
+
+    /// lock free histogram of values in power of two buckets, bucket i holding the values in [2^(i-1), 2^i), used for the durations in microseconds and sizes in bytes of the tile loading stages.
+    class VSGGIS_DECLSPEC LoadHistogram
+    {
+    public:
+        static constexpr size_t numBuckets = 48;
+
+        void add(uint64_t value);
+
+        uint64_t count() const { return _count.load(std::memory_order_relaxed); }
+        uint64_t total() const { return _total.load(std::memory_order_relaxed); }
+        uint64_t maximum() const { return _maximum.load(std::memory_order_relaxed); }
+        double mean() const;
+
+        /// estimate of the value below which the fraction of the values lie, interpolated within the bucket, fraction in the range 0.0 to 1.0
+        double percentile(double fraction) const;
+
+        uint64_t bucket(size_t i) const { return _buckets[i].load(std::memory_order_relaxed); }
+
+    protected:
+        std::array<std::atomic_uint64_t, numBuckets> _buckets = {};
+        std::atomic_uint64_t _count{0};
+        std::atomic_uint64_t _total{0};
+        std::atomic_uint64_t _maximum{0};
+    };
+
+    /// per stage timings and counters of the TileReader's load pipeline, so that when paging stalls the stage responsible can be identified.
+    /// Recording is lock free so can be left enabled on the loading threads. When maxTraceEvents is non zero the first maxTraceEvents stage timings are also recorded as events that can be written as Chrome trace JSON.
+    class VSGGIS_DECLSPEC TileLoadStats : public vsg::Inherit<vsg::Object, TileLoadStats>
+    {
+    public:
+        explicit TileLoadStats(size_t in_maxTraceEvents = 0);
+
+        enum Stage : uint32_t
+        {
+            FETCH_QUEUED,    // from issuing a fetch to a fetch thread starting it
+            FETCH,           // reading, and decoding, a tile from its file, URL or raster, excluding the caches
+            TILE_CACHE_READ, // reading a tile from the on disk TileCache
+            FETCH_WAIT,      // time read_root() or read_subtile() spend blocked waiting for fetches
+            PREPARE_TEXTURE, // block compressing, or passing through, the tile's image
+            CREATE_TILE,     // building the tile's subgraph, createECEFTile() including its vertices and heights
+            COMPUTE_BOUNDS,  // bounding the tile from its grid and height range, part of CREATE_TILE
+            READ_SUBTILE,    // the whole of read_subtile(), fetch to returned subgraph
+            UPLOAD_WAIT,     // read_subtile() waiting on the TileUploadBudget for its tiles to be released to the pager
+            NUM_STAGES
+        };
+
+        enum Counter : uint32_t
+        {
+            MEMORY_CACHE_HIT,
+            MEMORY_CACHE_MISS,
+            TILE_CACHE_HIT,
+            TILE_CACHE_MISS,
+            FETCH_FAILED,
+            NUM_COUNTERS
+        };
+
+        static const char* name(Stage stage);
+        static const char* name(Counter counter);
+
+        /// record the duration of a stage, and a trace event when enabled
+        void add(Stage stage, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+        /// record the size of a fetched tile
+        void addBytes(uint64_t bytes) { _fetchedBytes.add(bytes); }
+
+        void increment(Counter counter) { _counters[counter].fetch_add(1, std::memory_order_relaxed); }
+
+        /// stage durations in microseconds
+        const LoadHistogram& histogram(Stage stage) const { return _stages[stage]; }
+
+        /// sizes of the fetched tiles in bytes
+        const LoadHistogram& fetchedBytes() const { return _fetchedBytes; }
+
+        uint64_t count(Counter counter) const { return _counters[counter].load(std::memory_order_relaxed); }
+
+        const size_t maxTraceEvents;
+
+        /// print a table of the stages and counters
+        void print(std::ostream& out) const;
+
+        /// write a line per stage with its count and timings in milliseconds, followed by a line per counter. Return true on success.
+        bool writeCSV(const vsg::Path& filename) const;
+
+        /// write the recorded trace events as Chrome trace JSON, viewable in chrome://tracing or Perfetto. Return true on success.
+        bool writeChromeTrace(const vsg::Path& filename) const;
+
+    protected:
+        struct TraceEvent
+        {
+            Stage stage;
+            uint32_t threadIndex;
+            int64_t start;
+            int64_t duration;
+        };
+
+        uint32_t threadIndex();
+
+        std::chrono::steady_clock::time_point _startTime;
+        std::array<LoadHistogram, NUM_STAGES> _stages;
+        LoadHistogram _fetchedBytes;
+        std::array<std::atomic_uint64_t, NUM_COUNTERS> _counters = {};
+
+        std::vector<TraceEvent> _traceEvents;
+        std::atomic_size_t _numTraceEvents{0};
+        std::atomic_uint32_t _numThreads{0};
+    };
+
+} // namespace vsgGIS
+
+EVSG_type_name(vsgGIS::TileLoadStats);
@@ -0,0 +1,73 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/Export.h>
+
+#include <vsg/core/Inherit.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace vsgGIS
+{
+
+    /// limits the bytes of newly built tiles released to the DatabasePager each frame, so a burst of paged tiles is compiled, uploaded and merged over several frames instead of in one.
+    /// The loading threads call acquire() before returning their tiles and block until the tiles fit within the current frame's budget, advanceFrame() opens the next frame's budget.
+    /// Tiles larger than the whole budget are let through on their own at the start of a frame, and acquire() stops waiting once frames have stalled for maxWait seconds
+    /// so loads made without a viewer rendering, or while shutting down, aren't held. Thread safe.
+    class VSGGIS_DECLSPEC TileUploadBudget : public vsg::Inherit<vsg::Object, TileUploadBudget>
+    {
+    public:
+        explicit TileUploadBudget(uint64_t in_bytesPerFrame, double in_maxWait = 0.5);
+
+        const uint64_t bytesPerFrame;
+        const double maxWait;
+
+        /// start the budget of frame frameCount, repeated calls with the same frameCount, i.e. from multiple views of the same frame, are ignored
+        void advanceFrame(uint64_t frameCount);
+
+        /// block until bytes fit in the current frame's budget, then take them from it
+        void acquire(uint64_t bytes);
+
+        /// number of frames started, acquires that had to wait for a later frame, and bytes released
+        std::atomic_uint64_t numFrames{0};
+        std::atomic_uint64_t numDeferred{0};
+        std::atomic_uint64_t numBytes{0};
+
+    protected:
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _started = false;
+        uint64_t _frameCount = 0;
+        uint64_t _used = 0;
+        std::chrono::steady_clock::time_point _frameTime;
+    };
+
+} // namespace vsgGIS
+
+// Provide the means for the vsg::type_name<class> to get the human readable class name.
+EVSG_type_name(vsgGIS::TileUploadBudget);
@@ -0,0 +1,44 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/Export.h>
+
+#include <vsg/maths/EllipsoidModel.h>
+#include <vsg/maths/mat4.h>
+#include <vsg/maths/vec3.h>
+
+namespace vsgGIS
+{
+    /// convert a regular grid of latitude/longitude positions, in degrees, at a fixed altitude into float positions in the local coordinate frame provided by worldToLocal.
+    /// The grid is separable in latitude and longitude so the trigonometric and ellipsoid terms are computed once per row and once per column, leaving a multiply-add per vertex component that the compiler can vectorize.
+    /// If heights is non null it must point to numRows * numCols per vertex heights, laid out row by row, that are added to the altitude to displace each vertex along the ellipsoid normal.
+    /// vertices must point to numRows * numCols elements and is filled row by row.
+    extern VSGGIS_DECLSPEC void convertLatLongGridToLocal(const vsg::EllipsoidModel& ellipsoidModel, const double* latitudes, uint32_t numRows, const double* longitudes, uint32_t numCols, double altitude, const vsg::dmat4& worldToLocal, vsg::vec3* vertices, const float* heights = nullptr);
+
+    /// compute the ellipsoid normals of a regular grid of latitude/longitude positions, in degrees, rotated into the local coordinate frame provided by worldToLocal.
+    /// normals must point to numRows * numCols elements and is filled row by row.
+    extern VSGGIS_DECLSPEC void computeLatLongGridNormals(const double* latitudes, uint32_t numRows, const double* longitudes, uint32_t numCols, const vsg::dmat4& worldToLocal, vsg::vec3* normals);
+
+} // namespace vsgGIS
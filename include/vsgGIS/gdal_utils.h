@@ -28,12 +28,20 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "gdal_priv.h"
 #include "ogr_spatialref.h"
 
+#include <vsg/core/Array2D.h>
 #include <vsg/core/Data.h>
+#include <vsg/maths/vec2.h>
+#include <vsg/maths/vec3.h>
 #include <vsg/maths/vec4.h>
 #include <vsg/io/Path.h>
 
+#include <algorithm>
+#include <array>
+#include <limits>
 #include <memory>
 #include <set>
+#include <type_traits>
+#include <vector>
 
 namespace vsgGIS
 {
@@ -60,12 +68,179 @@ namespace vsgGIS
     /// return true if two GDALDataset has the same projection, geo transform and dimensions indicating they are perfectly pixel aliged and matched in size.
     extern VSGGIS_DECLSPEC bool compatibleDatasetProjectionsTransformAndSizes(const GDALDataset& lhs, const GDALDataset& rhs);
 
-    /// create a vsg::Image2D of the approrpiate type that maps to specified dimensions and GDALDataType
+    /// projection, geo transform and dimensions of a GDALDataset captured once, with the projection reduced to a hash of its canonical WKT,
+    /// so that checking many datasets for compatibility is a set of cheap comparisons rather than repeated projection string comparisons.
+    struct VSGGIS_DECLSPEC DatasetSignature
+    {
+        DatasetSignature() = default;
+        explicit DatasetSignature(GDALDataset& dataset);
+
+        size_t projectionHash = 0;
+        bool hasProjection = false;
+        bool hasGeoTransform = false;
+        std::array<double, 6> geoTransform = {0.0, 1.0, 0.0, 0.0, 0.0, 1.0};
+        int width = 0;
+        int height = 0;
+
+        /// equivalent of compatibleDatasetProjections()
+        bool compatibleProjection(const DatasetSignature& rhs) const;
+
+        /// equivalent of compatibleDatasetProjectionsTransformAndSizes()
+        bool compatibleProjectionTransformAndSize(const DatasetSignature& rhs) const;
+    };
+
+    /// open the files concurrently on numThreads threads, returning a GDALDataset per file, null for files that failed to open. When signatures is non null it's filled in with
+    /// the DatasetSignature of each dataset, computed on the opening threads.
+    extern VSGGIS_DECLSPEC std::vector<std::shared_ptr<GDALDataset>> openDataSets(const std::vector<vsg::Path>& filenames, GDALAccess access, uint32_t numThreads, std::vector<DatasetSignature>* signatures = nullptr);
+
+    /// mosaic datasets that share a projection and bands, but may differ in extents and resolution, into a single VRT dataset with GDALBuildVRT.
+    /// An empty filename creates the VRT in memory, only usable through the returned GDALDataset, while a /vsimem/ filename can also be opened by other threads. Return null on failure.
+    extern VSGGIS_DECLSPEC std::shared_ptr<GDALDataset> createMosaic(const std::vector<std::shared_ptr<GDALDataset>>& datasets, const vsg::Path& filename = {});
+
+    /// VkFormat of images with 1 to 4 components of type T, specialized for the component types that GDALDataType maps to
+    template<typename T>
+    struct ComponentFormats;
+
+    template<>
+    struct ComponentFormats<uint8_t>
+    {
+        static constexpr VkFormat formats[4] = {VK_FORMAT_R8_UNORM, VK_FORMAT_R8G8_UNORM, VK_FORMAT_R8G8B8_UNORM, VK_FORMAT_R8G8B8A8_UNORM};
+    };
+
+    template<>
+    struct ComponentFormats<uint16_t>
+    {
+        static constexpr VkFormat formats[4] = {VK_FORMAT_R16_UNORM, VK_FORMAT_R16G16_UNORM, VK_FORMAT_R16G16B16_UNORM, VK_FORMAT_R16G16B16A16_UNORM};
+    };
+
+    template<>
+    struct ComponentFormats<int16_t>
+    {
+        static constexpr VkFormat formats[4] = {VK_FORMAT_R16_SNORM, VK_FORMAT_R16G16_SNORM, VK_FORMAT_R16G16B16_SNORM, VK_FORMAT_R16G16B16A16_SNORM};
+    };
+
+    template<>
+    struct ComponentFormats<uint32_t>
+    {
+        static constexpr VkFormat formats[4] = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT};
+    };
+
+    template<>
+    struct ComponentFormats<int32_t>
+    {
+        static constexpr VkFormat formats[4] = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT};
+    };
+
+    template<>
+    struct ComponentFormats<float>
+    {
+        static constexpr VkFormat formats[4] = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+    };
+
+    template<>
+    struct ComponentFormats<double>
+    {
+        static constexpr VkFormat formats[4] = {VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT};
+    };
+
+    /// compile time mapping of numComponents components of type T to the vsg value type, Array2D type and VkFormat of the image.
+    template<typename T, int N>
+    struct ImageTraits
+    {
+        static_assert(N >= 1 && N <= 4, "images have 1 to 4 components");
+
+        using component_type = T;
+        using value_type = std::conditional_t<N == 1, T, std::conditional_t<N == 2, vsg::t_vec2<T>, std::conditional_t<N == 3, vsg::t_vec3<T>, vsg::t_vec4<T>>>>;
+        using array_type = vsg::Array2D<value_type>;
+
+        static constexpr int numComponents = N;
+        static constexpr VkFormat format = ComponentFormats<T>::formats[N - 1];
+
+        /// map the def values to components, for integer types values < 0.0 map to the minimum, > 0.0 to the maximum and 0.0 to 0.
+        static T component(double value)
+        {
+            if constexpr (std::numeric_limits<T>::is_integer)
+            {
+                if (value < 0.0) return std::numeric_limits<T>::min();
+                if (value > 0.0) return std::numeric_limits<T>::max();
+                return static_cast<T>(0);
+            }
+            else
+            {
+                return static_cast<T>(value);
+            }
+        }
+
+        static value_type value(const vsg::dvec4& def)
+        {
+            if constexpr (N == 1)
+                return component(def[0]);
+            else if constexpr (N == 2)
+                return value_type(component(def[0]), component(def[1]));
+            else if constexpr (N == 3)
+                return value_type(component(def[0]), component(def[1]), component(def[2]));
+            else
+                return value_type(component(def[0]), component(def[1]), component(def[2]), component(def[3]));
+        }
+    };
+
+    /// create an image with N components of type T, i.e. createImage2D<uint8_t, 4>(256, 256) for RGBA8, with every pixel set to def.
+    template<typename T, int N>
+    vsg::ref_ptr<typename ImageTraits<T, N>::array_type> createImage2D(uint32_t width, uint32_t height, const vsg::dvec4& def = {0.0, 0.0, 0.0, 1.0})
+    {
+        using Traits = ImageTraits<T, N>;
+        return Traits::array_type::create(width, height, Traits::value(def), vsg::Data::Layout{Traits::format});
+    }
+
+    /// create an image with N components of type T that views the memory of storage from offset, so repeated images such as tiles can reuse a buffer rather than allocating each time.
+    /// The image keeps a reference to storage, every pixel is set to def. Return null if storage is too small.
+    template<typename T, int N>
+    vsg::ref_ptr<typename ImageTraits<T, N>::array_type> createImage2D(uint32_t width, uint32_t height, vsg::ref_ptr<vsg::Data> storage, size_t offset, const vsg::dvec4& def = {0.0, 0.0, 0.0, 1.0})
+    {
+        using Traits = ImageTraits<T, N>;
+        using value_type = typename Traits::value_type;
+
+        size_t size = sizeof(value_type) * size_t(width) * size_t(height);
+        if (!storage || offset + size > storage->dataSize()) return {};
+
+        auto image = Traits::array_type::create(storage, static_cast<uint32_t>(offset), static_cast<uint32_t>(sizeof(value_type)), width, height, vsg::Data::Layout{Traits::format});
+        std::fill(image->begin(), image->end(), Traits::value(def));
+        return image;
+    }
+
+    /// create a vsg::Image2D of the approrpiate type that maps to specified dimensions and GDALDataType, dispatching to createImage2D<T, N>(). Return null for unsupported combinations.
     extern VSGGIS_DECLSPEC vsg::ref_ptr<vsg::Data> createImage2D(int width, int height, int numComponents, GDALDataType dataType, vsg::dvec4 def = {0.0, 0.0, 0.0, 1.0});
 
+    /// create a vsg::Image2D of the approrpiate type that maps to specified dimensions and GDALDataType in the memory of storage from offset. Return null for unsupported combinations or when storage is too small.
+    extern VSGGIS_DECLSPEC vsg::ref_ptr<vsg::Data> createImage2D(int width, int height, int numComponents, GDALDataType dataType, vsg::ref_ptr<vsg::Data> storage, size_t offset, vsg::dvec4 def = {0.0, 0.0, 0.0, 1.0});
+
     /// copy a RasterBand onto a target RGBA component of a vsg::Data.  Dimensions and datatypes must be compatble between RasterBand and vsg::Data. Return true on success, false on failure to copy.
+    /// Uses RasterIO to write the component directly into the interleaved image, falling back to copyRasterBandToImageByBlocks() if RasterIO fails.
     extern VSGGIS_DECLSPEC bool copyRasterBandToImage(GDALRasterBand& band, vsg::Data& image, int component);
 
+    /// copy the window of a RasterBand at xOffset, yOffset, with the dimensions of the image, onto a target RGBA component of a vsg::Data. The window must lie within the RasterBand. Return true on success, false on failure to copy.
+    extern VSGGIS_DECLSPEC bool copyRasterBandWindowToImage(GDALRasterBand& band, int xOffset, int yOffset, vsg::Data& image, int component);
+
+    /// copy a RasterBand onto a target RGBA component of a vsg::Data by reading each block with ReadBlock and interleaving it into the image. Return true on success, false on failure to copy.
+    extern VSGGIS_DECLSPEC bool copyRasterBandToImageByBlocks(GDALRasterBand& band, vsg::Data& image, int component);
+
+    /// windowed version of copyRasterBandToImageByBlocks(), only the blocks overlapping the window are read.
+    extern VSGGIS_DECLSPEC bool copyRasterBandWindowToImageByBlocks(GDALRasterBand& band, int xOffset, int yOffset, vsg::Data& image, int component);
+
+    /// copy the specified bands, numbered from 1, of a GDALDataset onto consecutive RGBA components of a vsg::Data starting at firstComponent with a single GDALDataset::RasterIO call.
+    /// Dimensions and datatypes must be compatble between the bands and vsg::Data. Return true on success, false on failure to copy.
+    extern VSGGIS_DECLSPEC bool copyRasterBandsToImage(GDALDataset& dataset, const std::vector<int>& bands, vsg::Data& image, int firstComponent = 0);
+
+    /// windowed version of copyRasterBandsToImage(), copying the window at xOffset, yOffset with the dimensions of the image.
+    extern VSGGIS_DECLSPEC bool copyRasterBandsWindowToImage(GDALDataset& dataset, const std::vector<int>& bands, int xOffset, int yOffset, vsg::Data& image, int firstComponent = 0);
+
+    /// parallel version of copyRasterBandsToImage() which reads strips of block rows concurrently on numThreads threads, each thread opening its own GDALDataset from filename as GDAL handles aren't thread safe.
+    /// The strips cover disjoint rows of the image so no synchronization of the writes is required. Return true on success, false on failure to open or copy.
+    extern VSGGIS_DECLSPEC bool copyRasterBandsToImage(const vsg::Path& filename, const std::vector<int>& bands, vsg::Data& image, int firstComponent, uint32_t numThreads);
+
+    /// windowed version of the parallel copyRasterBandsToImage(), copying the window at xOffset, yOffset with the dimensions of the image.
+    extern VSGGIS_DECLSPEC bool copyRasterBandsWindowToImage(const vsg::Path& filename, const std::vector<int>& bands, int xOffset, int yOffset, vsg::Data& image, int firstComponent, uint32_t numThreads);
+
     /// assign GDAL MetaData mapping the "key=value" entries to vsg::Object as setValue(key, std::string(value)).
     extern VSGGIS_DECLSPEC bool assignMetaData(GDALDataset& dataset, vsg::Object& object);
 
@@ -0,0 +1,61 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/Export.h>
+#include <vsgGIS/TileDataPool.h>
+
+#include <vsg/core/Data.h>
+
+namespace vsgGIS
+{
+    /// return true if format is one of the block compressed formats supported by compressImage().
+    extern VSGGIS_DECLSPEC bool isSupportedCompressedFormat(VkFormat format);
+
+    /// compress an 8 bit RGB or RGBA image to the block compressed format, VK_FORMAT_BC1_RGB_UNORM_BLOCK or VK_FORMAT_BC3_UNORM_BLOCK, generating a box filtered mipmap chain of up to maxNumMipmaps levels.
+    /// The sRGB variant of the format is used when the image has an sRGB format. Returns null if the image or format isn't supported, in which case the original image should be used.
+    /// Rendering the result requires the textureCompressionBC device feature. The compressed blocks are allocated from pool when it's non null.
+    extern VSGGIS_DECLSPEC vsg::ref_ptr<vsg::Data> compressImage(const vsg::Data& image, VkFormat format, uint32_t maxNumMipmaps, TileDataPool* pool = nullptr);
+
+    /// return the number of mipmap levels, including the base level, of a width x height image, at most maxNumMipmaps and stopping at the level whose larger dimension is minMipmapSize.
+    extern VSGGIS_DECLSPEC uint32_t computeNumMipmaps(uint32_t width, uint32_t height, uint32_t maxNumMipmaps, uint32_t minMipmapSize = 1);
+
+    /// generate the box filtered mipmap chain, of up to maxNumMipmaps levels capped by minMipmapSize, of an uncompressed 2D image, returning an image of the same type that holds all the levels.
+    /// Uploading the result copies the levels rather than generating them on the GPU. Returns null if the image already has mipmaps, only needs a single level or isn't supported, in which case the original image should be used.
+    /// The levels are allocated from pool when it's non null.
+    extern VSGGIS_DECLSPEC vsg::ref_ptr<vsg::Data> generateMipmaps(const vsg::Data& image, uint32_t maxNumMipmaps, uint32_t minMipmapSize = 1, TileDataPool* pool = nullptr);
+
+    /// return true if the two uncompressed images have the same type, dimensions, format and origin so can be layers of the same texture array.
+    extern VSGGIS_DECLSPEC bool compatibleTextureLayers(const vsg::Data& lhs, const vsg::Data& rhs);
+
+    /// copy compatible 2D images into the layers of a 2D texture array, 8 bit RGB images are expanded to RGBA and only the base level of mipmapped images is copied. Returns null if the images aren't compatible or of a supported type.
+    /// The array is allocated from pool when it's non null.
+    extern VSGGIS_DECLSPEC vsg::ref_ptr<vsg::Data> createTextureArray(const vsg::DataList& layers, TileDataPool* pool = nullptr);
+
+    /// upsample the quadrantX, quadrantY quadrant, each 0 or 1 in the order of the image's columns and rows, of an uncompressed 2D image to an image of the same type and dimensions by pixel doubling.
+    /// Used to stand in for a tile that couldn't be loaded with the matching region of its parent, the texture filtering smooths the doubled pixels. Returns null if the image isn't supported.
+    /// The image is allocated from pool when it's non null.
+    extern VSGGIS_DECLSPEC vsg::ref_ptr<vsg::Data> upsampleQuadrant(const vsg::Data& image, uint32_t quadrantX, uint32_t quadrantY, TileDataPool* pool = nullptr);
+
+} // namespace vsgGIS
@@ -0,0 +1,95 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/HorizonCullNode.h>
+
+#include <vsg/io/Input.h>
+#include <vsg/io/ObjectFactory.h>
+#include <vsg/io/Output.h>
+#include <vsg/traversals/RecordTraversal.h>
+#include <vsg/vk/State.h>
+
+using namespace vsgGIS;
+
+// Register the HorizonCullNode class with vsg::ObjectFactory::instance() so it can be used for creating objects during reading.
+vsg::RegisterWithObjectFactoryProxy<vsgGIS::HorizonCullNode> s_Register_HorizonCullNode;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  HorizonCullNode
+//
+HorizonCullNode::HorizonCullNode() :
+    radii(1.0, 1.0, 1.0)
+{
+}
+
+HorizonCullNode::HorizonCullNode(const vsg::dvec3& in_radii, const vsg::dvec3& in_horizonOcclusionPoint, vsg::ref_ptr<vsg::Node> in_child) :
+    radii(in_radii),
+    horizonOcclusionPoint(in_horizonOcclusionPoint),
+    child(in_child)
+{
+}
+
+bool HorizonCullNode::occluded(const vsg::dvec3& eye) const
+{
+    // in the scaled space the ellipsoid is a unit sphere, the point is hidden when it's beyond the plane of the horizon and within the cone the sphere casts from the eye
+    vsg::dvec3 scaledEye(eye.x / radii.x, eye.y / radii.y, eye.z / radii.z);
+    double horizonDistance2 = vsg::length2(scaledEye) - 1.0;
+    if (horizonDistance2 <= 0.0) return false;
+
+    vsg::dvec3 eyeToPoint = horizonOcclusionPoint - scaledEye;
+    double eyeToPointDotEye = -vsg::dot(eyeToPoint, scaledEye);
+    return eyeToPointDotEye > horizonDistance2 && (eyeToPointDotEye * eyeToPointDotEye) / vsg::length2(eyeToPoint) > horizonDistance2;
+}
+
+void HorizonCullNode::traverse(vsg::RecordTraversal& visitor) const
+{
+    if (!child) return;
+
+    // the eye is the inverse of the modelview's rigid transform, -transpose(rotation) * translation, which avoids a full matrix inverse per tile
+    auto& mv = visitor.getState()->modelviewMatrixStack.top();
+    vsg::dvec3 translation(mv[3][0], mv[3][1], mv[3][2]);
+    vsg::dvec3 eye(-(mv[0][0] * translation.x + mv[0][1] * translation.y + mv[0][2] * translation.z),
+                   -(mv[1][0] * translation.x + mv[1][1] * translation.y + mv[1][2] * translation.z),
+                   -(mv[2][0] * translation.x + mv[2][1] * translation.y + mv[2][2] * translation.z));
+
+    if (!occluded(eye)) child->accept(visitor);
+}
+
+void HorizonCullNode::read(vsg::Input& input)
+{
+    Node::read(input);
+
+    input.read("radii", radii);
+    input.read("horizonOcclusionPoint", horizonOcclusionPoint);
+    input.readObject("child", child);
+}
+
+void HorizonCullNode::write(vsg::Output& output) const
+{
+    Node::write(output);
+
+    output.write("radii", radii);
+    output.write("horizonOcclusionPoint", horizonOcclusionPoint);
+    output.writeObject("child", child);
+}
@@ -0,0 +1,237 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/MappedTile.h>
+#include <vsgGIS/gdal_utils.h>
+
+#include <vsg/core/Array2D.h>
+#include <vsg/core/Array3D.h>
+#include <vsg/io/FileSystem.h>
+#include <vsg/io/Logger.h>
+#include <vsg/io/Options.h>
+
+#include <cstring>
+#include <fstream>
+
+#if defined(_WIN32)
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+using namespace vsgGIS;
+
+namespace
+{
+    // the data is aligned so that the mapped values can be accessed in place
+    constexpr uint64_t dataAlignment = 64;
+
+    // byte array whose data is a private memory mapping of a file, released and unmapped on destruction rather than deleted
+    class MappedArray : public vsg::Inherit<vsg::ubyteArray, MappedArray>
+    {
+    public:
+        MappedArray(uint8_t* ptr, size_t size) :
+            Inherit(static_cast<uint32_t>(size), ptr) {}
+
+        ~MappedArray()
+        {
+            void* ptr = dataPointer();
+            size_t size = dataSize();
+            dataRelease();
+
+#if defined(_WIN32)
+            UnmapViewOfFile(ptr);
+#else
+            munmap(ptr, size);
+#endif
+        }
+
+        static vsg::ref_ptr<MappedArray> map(const vsg::Path& filename)
+        {
+#if defined(_WIN32)
+            HANDLE file = CreateFileW(filename.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return {};
+
+            LARGE_INTEGER fileSize;
+            HANDLE mapping = nullptr;
+            if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+            CloseHandle(file);
+            if (!mapping) return {};
+
+            // the view keeps the mapping alive after its handle is closed
+            void* ptr = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+            CloseHandle(mapping);
+            if (!ptr) return {};
+
+            return MappedArray::create(static_cast<uint8_t*>(ptr), static_cast<size_t>(fileSize.QuadPart));
+#else
+            int fd = open(filename.string().c_str(), O_RDONLY);
+            if (fd < 0) return {};
+
+            struct stat fileStat;
+            void* ptr = MAP_FAILED;
+            if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) ptr = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+            // the mapping remains valid after the file is closed
+            close(fd);
+            if (ptr == MAP_FAILED) return {};
+
+            return MappedArray::create(static_cast<uint8_t*>(ptr), static_cast<size_t>(fileStat.st_size));
+#endif
+        }
+    };
+
+    template<typename T>
+    vsg::ref_ptr<vsg::Data> createView(vsg::ref_ptr<vsg::Data> storage, const MappedTileHeader& header, const vsg::Data::Layout& layout)
+    {
+        if (header.valueSize != sizeof(T)) return {};
+
+        auto offset = static_cast<uint32_t>(header.dataOffset);
+        if (header.depth > 1) return vsg::Array3D<T>::create(storage, offset, sizeof(T), header.width, header.height, header.depth, layout);
+        return vsg::Array2D<T>::create(storage, offset, sizeof(T), header.width, header.height, layout);
+    }
+
+    // select the value type from the 1 to 4 component formats of component type T
+    template<typename T>
+    vsg::ref_ptr<vsg::Data> createComponentView(vsg::ref_ptr<vsg::Data> storage, const MappedTileHeader& header, const vsg::Data::Layout& layout)
+    {
+        auto& formats = ComponentFormats<T>::formats;
+        if (layout.format == formats[0]) return createView<T>(storage, header, layout);
+        if (layout.format == formats[1]) return createView<vsg::t_vec2<T>>(storage, header, layout);
+        if (layout.format == formats[2]) return createView<vsg::t_vec3<T>>(storage, header, layout);
+        if (layout.format == formats[3]) return createView<vsg::t_vec4<T>>(storage, header, layout);
+        return {};
+    }
+
+    vsg::ref_ptr<vsg::Data> createView(vsg::ref_ptr<vsg::Data> storage, const MappedTileHeader& header, const vsg::Data::Layout& layout)
+    {
+        switch (layout.format)
+        {
+        case (VK_FORMAT_R8_SRGB): return createView<uint8_t>(storage, header, layout);
+        case (VK_FORMAT_R8G8_SRGB): return createView<vsg::ubvec2>(storage, header, layout);
+        case (VK_FORMAT_R8G8B8_SRGB): return createView<vsg::ubvec3>(storage, header, layout);
+        case (VK_FORMAT_R8G8B8A8_SRGB): return createView<vsg::ubvec4>(storage, header, layout);
+        case (VK_FORMAT_BC1_RGB_UNORM_BLOCK):
+        case (VK_FORMAT_BC1_RGB_SRGB_BLOCK):
+        case (VK_FORMAT_BC1_RGBA_UNORM_BLOCK):
+        case (VK_FORMAT_BC1_RGBA_SRGB_BLOCK): return createView<vsg::block64>(storage, header, layout);
+        case (VK_FORMAT_BC3_UNORM_BLOCK):
+        case (VK_FORMAT_BC3_SRGB_BLOCK): return createView<vsg::block128>(storage, header, layout);
+        default: break;
+        }
+
+        vsg::ref_ptr<vsg::Data> view;
+        if ((view = createComponentView<uint8_t>(storage, header, layout))) return view;
+        if ((view = createComponentView<uint16_t>(storage, header, layout))) return view;
+        if ((view = createComponentView<int16_t>(storage, header, layout))) return view;
+        if ((view = createComponentView<uint32_t>(storage, header, layout))) return view;
+        if ((view = createComponentView<int32_t>(storage, header, layout))) return view;
+        if ((view = createComponentView<float>(storage, header, layout))) return view;
+        return createComponentView<double>(storage, header, layout);
+    }
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MappedTileReaderWriter
+//
+vsg::ref_ptr<vsg::Object> MappedTileReaderWriter::read(const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> options) const
+{
+    if (vsg::lowerCaseFileExtension(filename) != ".vsgm") return {};
+
+    auto filenameToUse = vsg::findFile(filename, options);
+    if (filenameToUse.empty()) return {};
+
+    auto mapped = MappedArray::map(filenameToUse);
+    if (!mapped || mapped->dataSize() < sizeof(MappedTileHeader)) return {};
+
+    MappedTileHeader header;
+    std::memcpy(&header, mapped->dataPointer(), sizeof(MappedTileHeader));
+    if (std::memcmp(header.magic, MappedTileHeader().magic, sizeof(header.magic)) != 0 || header.version != 1)
+    {
+        vsg::warn("MappedTileReaderWriter::read() ", filenameToUse, " is not a supported .vsgm file.");
+        return {};
+    }
+
+    uint64_t numValues = uint64_t(header.width) * uint64_t(header.height) * uint64_t(std::max(header.depth, 1u));
+    if (header.dataOffset % dataAlignment != 0 || header.dataSize < numValues * header.valueSize || header.dataOffset + header.dataSize > mapped->dataSize())
+    {
+        vsg::warn("MappedTileReaderWriter::read() ", filenameToUse, " is truncated or corrupt.");
+        return {};
+    }
+
+    vsg::Data::Layout layout;
+    layout.format = static_cast<VkFormat>(header.format);
+    layout.stride = header.valueSize;
+    layout.maxNumMipmaps = header.maxNumMipmaps;
+    layout.blockWidth = header.blockWidth;
+    layout.blockHeight = header.blockHeight;
+    layout.blockDepth = header.blockDepth;
+    layout.origin = header.origin;
+    layout.imageViewType = header.imageViewType;
+
+    auto view = createView(mapped, header, layout);
+    if (!view) vsg::warn("MappedTileReaderWriter::read() ", filenameToUse, " unsupported format ", header.format);
+    return view;
+}
+
+bool MappedTileReaderWriter::write(const vsg::Object* object, const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> /*options*/) const
+{
+    if (vsg::lowerCaseFileExtension(filename) != ".vsgm") return false;
+
+    auto data = dynamic_cast<const vsg::Data*>(object);
+    if (!data || data->dimensions() < 2 || !data->dataPointer()) return false;
+
+    auto& layout = data->getLayout();
+
+    MappedTileHeader header;
+    header.format = static_cast<uint32_t>(layout.format);
+    header.valueSize = static_cast<uint32_t>(data->valueSize());
+    header.width = data->width();
+    header.height = data->height();
+    header.depth = data->depth();
+    header.maxNumMipmaps = layout.maxNumMipmaps;
+    header.blockWidth = layout.blockWidth;
+    header.blockHeight = layout.blockHeight;
+    header.blockDepth = layout.blockDepth;
+    header.origin = layout.origin;
+    header.imageViewType = layout.imageViewType;
+    header.dataOffset = ((sizeof(MappedTileHeader) + dataAlignment - 1) / dataAlignment) * dataAlignment;
+    header.dataSize = uint64_t(data->computeValueCountIncludingMipmaps()) * data->valueSize();
+
+    std::ofstream fout(filename.string(), std::ios::out | std::ios::binary);
+    if (!fout) return false;
+
+    char padding[dataAlignment] = {};
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(MappedTileHeader));
+    fout.write(padding, static_cast<std::streamsize>(header.dataOffset - sizeof(MappedTileHeader)));
+    fout.write(static_cast<const char*>(data->dataPointer()), static_cast<std::streamsize>(header.dataSize));
+
+    return fout.good();
+}
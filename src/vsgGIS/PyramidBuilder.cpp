@@ -0,0 +1,446 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/MappedTile.h>
+#include <vsgGIS/PyramidBuilder.h>
+#include <vsgGIS/texture_utils.h>
+
+#include <vsg/io/FileSystem.h>
+#include <vsg/io/Logger.h>
+#include <vsg/io/read.h>
+#include <vsg/io/write.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+
+using namespace vsgGIS;
+
+// radius of the sphere used by EPSG:3857
+static constexpr double mercatorRadius = 6378137.0;
+
+template<typename T>
+static void downsample(const vsg::Data& child, vsg::Data& parent, uint32_t offsetX, uint32_t offsetY, int numComponents)
+{
+    uint32_t childWidth = child.width();
+    uint32_t parentWidth = parent.width();
+    uint32_t width = child.width() / 2;
+    uint32_t height = child.height() / 2;
+
+    for (uint32_t r = 0; r < height; ++r)
+    {
+        for (uint32_t c = 0; c < width; ++c)
+        {
+            size_t i00 = (r * 2) * childWidth + c * 2;
+            size_t i10 = i00 + childWidth;
+            const T* p00 = static_cast<const T*>(child.dataPointer(i00));
+            const T* p01 = static_cast<const T*>(child.dataPointer(i00 + 1));
+            const T* p10 = static_cast<const T*>(child.dataPointer(i10));
+            const T* p11 = static_cast<const T*>(child.dataPointer(i10 + 1));
+            T* dest = static_cast<T*>(parent.dataPointer((offsetY + r) * parentWidth + offsetX + c));
+
+            for (int i = 0; i < numComponents; ++i)
+            {
+                double average = (double(p00[i]) + double(p01[i]) + double(p10[i]) + double(p11[i])) * 0.25;
+                if constexpr (std::is_integral_v<T>)
+                    dest[i] = static_cast<T>(std::round(average));
+                else
+                    dest[i] = static_cast<T>(average);
+            }
+        }
+    }
+}
+
+static bool downsample(GDALDataType dataType, const vsg::Data& child, vsg::Data& parent, uint32_t offsetX, uint32_t offsetY, int numComponents)
+{
+    switch (dataType)
+    {
+    case (GDT_Byte): downsample<uint8_t>(child, parent, offsetX, offsetY, numComponents); return true;
+    case (GDT_UInt16): downsample<uint16_t>(child, parent, offsetX, offsetY, numComponents); return true;
+    case (GDT_Int16): downsample<int16_t>(child, parent, offsetX, offsetY, numComponents); return true;
+    case (GDT_UInt32): downsample<uint32_t>(child, parent, offsetX, offsetY, numComponents); return true;
+    case (GDT_Int32): downsample<int32_t>(child, parent, offsetX, offsetY, numComponents); return true;
+    case (GDT_Float32): downsample<float>(child, parent, offsetX, offsetY, numComponents); return true;
+    case (GDT_Float64): downsample<double>(child, parent, offsetX, offsetY, numComponents); return true;
+    default: return false;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  PyramidBuilder
+//
+
+// the GDAL handles used by a single thread, declared so that the warped VRT is closed before the mosaic and datasets it references
+struct PyramidBuilder::Source
+{
+    std::vector<std::shared_ptr<GDALDataset>> datasets;
+    std::shared_ptr<GDALDataset> mosaic;
+    std::shared_ptr<GDALDataset> warped;
+    double geoTransform[6];
+    int width = 0;
+    int height = 0;
+};
+
+PyramidBuilder::PyramidBuilder() :
+    settings(TileDatabaseSettings::create()),
+    options(vsg::Options::create())
+{
+    options->readerWriters.push_back(MappedTileReaderWriter::create());
+}
+
+bool PyramidBuilder::mercator() const
+{
+    return settings->projection == "EPSG:3857" || settings->projection == "spherical-mercator";
+}
+
+vsg::dvec2 PyramidBuilder::toProjected(const vsg::dvec2& coord) const
+{
+    // TileReader::computeLatitudeLongitudeAltitude() maps the y extents of +/-90 onto the full +/-PI range of spherical mercator
+    if (mercator())
+        return vsg::dvec2(vsg::radians(coord.x) * mercatorRadius, 2.0 * vsg::radians(coord.y) * mercatorRadius);
+    else
+        return coord;
+}
+
+vsg::dvec2 PyramidBuilder::fromProjected(const vsg::dvec2& coord) const
+{
+    if (mercator())
+        return vsg::dvec2(vsg::degrees(coord.x / mercatorRadius), vsg::degrees(coord.y / (2.0 * mercatorRadius)));
+    else
+        return coord;
+}
+
+std::unique_ptr<PyramidBuilder::Source> PyramidBuilder::openSource(const std::vector<vsg::Path>& sources) const
+{
+    auto closeDataset = [](GDALDataset* dataset) { GDALClose(dataset); };
+
+    auto source = std::make_unique<Source>();
+    for (auto& filename : sources)
+    {
+        auto dataset = openDataSet(filename, GA_ReadOnly);
+        if (!dataset)
+        {
+            vsg::warn("PyramidBuilder unable to open ", filename);
+            return {};
+        }
+        source->datasets.push_back(dataset);
+    }
+
+    GDALDatasetH input = source->datasets.front().get();
+    if (source->datasets.size() > 1)
+    {
+        // mosaic multiple sources into an in memory VRT so they are reprojected as one
+        source->mosaic = createMosaic(source->datasets);
+        if (!source->mosaic)
+        {
+            vsg::warn("PyramidBuilder unable to mosaic sources, the sources must share a projection and number of bands.");
+            return {};
+        }
+        input = source->mosaic.get();
+    }
+
+    source->warped = std::shared_ptr<GDALDataset>(static_cast<GDALDataset*>(GDALAutoCreateWarpedVRT(input, nullptr, targetWKT.c_str(), resampleAlg, 0.125, nullptr)), closeDataset);
+    if (!source->warped || source->warped->GetGeoTransform(source->geoTransform) != CE_None)
+    {
+        vsg::warn("PyramidBuilder unable to reproject sources to ", settings->projection);
+        return {};
+    }
+
+    source->width = source->warped->GetRasterXSize();
+    source->height = source->warped->GetRasterYSize();
+
+    return source;
+}
+
+PyramidBuilder::TileRange PyramidBuilder::computeTileRange(const vsg::dbox& bounds, uint32_t level) const
+{
+    auto& extents = settings->extents;
+    if (bounds.max.x <= extents.min.x || bounds.min.x >= extents.max.x || bounds.max.y <= extents.min.y || bounds.min.y >= extents.max.y) return {};
+
+    double multiplier = pow(0.5, double(level));
+    double tileWidth = multiplier * (extents.max.x - extents.min.x) / double(settings->noX);
+    double tileHeight = multiplier * (extents.max.y - extents.min.y) / double(settings->noY);
+    uint32_t numX = settings->noX << level;
+    uint32_t numY = settings->noY << level;
+
+    auto index = [](double value, uint32_t num) { return static_cast<uint32_t>(std::clamp(value, 0.0, double(num - 1))); };
+
+    TileRange range;
+    range.minX = index(std::floor((bounds.min.x - extents.min.x) / tileWidth), numX);
+    range.maxX = index(std::ceil((bounds.max.x - extents.min.x) / tileWidth) - 1.0, numX);
+    if (settings->originTopLeft)
+    {
+        range.minY = index(std::floor((extents.max.y - bounds.max.y) / tileHeight), numY);
+        range.maxY = index(std::ceil((extents.max.y - bounds.min.y) / tileHeight) - 1.0, numY);
+    }
+    else
+    {
+        range.minY = index(std::floor((bounds.min.y - extents.min.y) / tileHeight), numY);
+        range.maxY = index(std::ceil((bounds.max.y - extents.min.y) / tileHeight) - 1.0, numY);
+    }
+    return range;
+}
+
+vsg::Path PyramidBuilder::getTilePath(uint32_t x, uint32_t y, uint32_t level) const
+{
+    auto replace = [](vsg::Path& path, const std::string& match, uint32_t value) {
+        std::stringstream sstr;
+        sstr << value;
+        auto levelPos = path.find(match);
+        if (levelPos != vsg::Path::npos) path.replace(levelPos, match.length(), sstr.str());
+    };
+
+    vsg::Path path = settings->imageLayer;
+    replace(path, "{z}", level);
+    replace(path, "{x}", x);
+    replace(path, "{y}", y);
+
+    return path;
+}
+
+vsg::ref_ptr<vsg::Data> PyramidBuilder::readTile(Source& source, uint32_t x, uint32_t y, uint32_t level) const
+{
+    auto tile_extents = settings->computeTileExtents(x, y, level);
+    auto& gt = source.geoTransform;
+
+    // window of the tile in the pixel coordinates of the reprojected sources
+    vsg::dvec2 topLeft = toProjected(vsg::dvec2(tile_extents.min.x, tile_extents.max.y));
+    vsg::dvec2 bottomRight = toProjected(vsg::dvec2(tile_extents.max.x, tile_extents.min.y));
+    double px0 = (topLeft.x - gt[0]) / gt[1];
+    double px1 = (bottomRight.x - gt[0]) / gt[1];
+    double py0 = (topLeft.y - gt[3]) / gt[5];
+    double py1 = (bottomRight.y - gt[3]) / gt[5];
+    double scaleX = (px1 - px0) / double(tileSize);
+    double scaleY = (py1 - py0) / double(tileSize);
+
+    // clip the window to the sources, the overlap is read into the corresponding part of the tile
+    double cx0 = std::max(px0, 0.0);
+    double cx1 = std::min(px1, double(source.width));
+    double cy0 = std::max(py0, 0.0);
+    double cy1 = std::min(py1, double(source.height));
+    if (cx1 <= cx0 || cy1 <= cy0) return {};
+
+    auto bufferIndex = [&](double value) { return static_cast<int>(std::clamp(std::round(value), 0.0, double(tileSize))); };
+    int bx0 = bufferIndex((cx0 - px0) / scaleX);
+    int bx1 = bufferIndex((cx1 - px0) / scaleX);
+    int by0 = bufferIndex((cy0 - py0) / scaleY);
+    int by1 = bufferIndex((cy1 - py0) / scaleY);
+    if (bx1 <= bx0 || by1 <= by0) return {};
+
+    auto tile = createImage2D(tileSize, tileSize, numComponents, dataType, vsg::dvec4(0.0, 0.0, 0.0, 1.0));
+    if (!tile) return {};
+
+    int xOffset = static_cast<int>(std::floor(cx0));
+    int yOffset = static_cast<int>(std::floor(cy0));
+    int xSize = std::min(static_cast<int>(std::ceil(cx1)), source.width) - xOffset;
+    int ySize = std::min(static_cast<int>(std::ceil(cy1)), source.height) - yOffset;
+
+    GDALRasterIOExtraArg extraArg;
+    INIT_RASTERIO_EXTRA_ARG(extraArg);
+    extraArg.eResampleAlg = (resampleAlg == GRA_NearestNeighbour) ? GRIORA_NearestNeighbour : GRIORA_Bilinear;
+    extraArg.bFloatingPointWindowValidity = TRUE;
+    extraArg.dfXOff = cx0;
+    extraArg.dfYOff = cy0;
+    extraArg.dfXSize = cx1 - cx0;
+    extraArg.dfYSize = cy1 - cy0;
+
+    std::vector<int> bands(numBands);
+    std::iota(bands.begin(), bands.end(), 1);
+
+    GSpacing pixelSpace = tile->getLayout().stride;
+    GSpacing lineSpace = pixelSpace * tileSize;
+    GSpacing bandSpace = GDALGetDataTypeSizeBytes(dataType);
+    void* ptr = tile->dataPointer(size_t(by0) * tileSize + size_t(bx0));
+
+    if (source.warped->RasterIO(GF_Read, xOffset, yOffset, xSize, ySize, ptr, bx1 - bx0, by1 - by0, dataType, numBands, bands.data(), pixelSpace, lineSpace, bandSpace, &extraArg) != CE_None)
+    {
+        vsg::warn("PyramidBuilder unable to read tile ", x, " ", y, " ", level);
+        return {};
+    }
+
+    return tile;
+}
+
+vsg::ref_ptr<vsg::Data> PyramidBuilder::downsampleTile(uint32_t x, uint32_t y, uint32_t level) const
+{
+    vsg::ref_ptr<vsg::Data> tile;
+    uint32_t halfSize = tileSize / 2;
+
+    for (uint32_t dy = 0; dy < 2; ++dy)
+    {
+        for (uint32_t dx = 0; dx < 2; ++dx)
+        {
+            // children outside the sources weren't written, leaving that quadrant of the parent at the default value
+            auto child = vsg::read_cast<vsg::Data>(getTilePath(x * 2 + dx, y * 2 + dy, level + 1), options);
+            if (!child || child->width() != tileSize || child->height() != tileSize) continue;
+
+            if (!tile)
+            {
+                tile = createImage2D(tileSize, tileSize, numComponents, dataType, vsg::dvec4(0.0, 0.0, 0.0, 1.0));
+                if (!tile || tile->getLayout().stride != child->getLayout().stride) return {};
+            }
+
+            // image rows run from the top of the tile, so with a bottom left origin the first row of children lies in the lower half of the image
+            uint32_t row = settings->originTopLeft ? dy : (1 - dy);
+            downsample(dataType, *child, *tile, dx * halfSize, row * halfSize, numComponents);
+        }
+    }
+
+    return tile;
+}
+
+bool PyramidBuilder::writeTile(vsg::ref_ptr<vsg::Data> tile, uint32_t x, uint32_t y, uint32_t level)
+{
+    auto path = getTilePath(x, y, level);
+
+    // the lower levels are built from the base level of the written tiles so the mipmaps are only added as the tile is written
+    if (mipmapLevels > 1)
+    {
+        if (auto mipmapped = generateMipmaps(*tile, mipmapLevels, minMipmapSize)) tile = mipmapped;
+    }
+
+    // several threads may create the same directory, so rely on the write to report failure
+    vsg::makeDirectory(vsg::filePath(path));
+
+    if (!vsg::write(tile, path, options))
+    {
+        vsg::warn("PyramidBuilder unable to write ", path);
+        return false;
+    }
+
+    ++numTilesWritten;
+    return true;
+}
+
+bool PyramidBuilder::build(const std::vector<vsg::Path>& sources)
+{
+    if (!settings || sources.empty() || tileSize < 2) return false;
+
+    OGRSpatialReference srs;
+    if (srs.SetFromUserInput(mercator() ? "EPSG:3857" : "EPSG:4326") != OGRERR_NONE) return false;
+
+    char* wkt = nullptr;
+    srs.exportToWkt(&wkt);
+    targetWKT = wkt ? wkt : "";
+    CPLFree(wkt);
+
+    auto source = openSource(sources);
+    if (!source) return false;
+
+    auto types = dataTypes(*source->warped);
+    numBands = std::min(source->warped->GetRasterCount(), 4);
+    if (types.size() != 1 || numBands == 0)
+    {
+        vsg::warn("PyramidBuilder requires 1 to 4 raster bands of a single data type.");
+        return false;
+    }
+
+    dataType = *types.begin();
+    numComponents = (numBands == 3) ? 4 : numBands;
+    if (!createImage2D(1, 1, numComponents, dataType))
+    {
+        vsg::warn("PyramidBuilder unsupported data type ", GDALGetDataTypeName(dataType));
+        return false;
+    }
+
+    // bounds of the reprojected sources in settings coordinates
+    auto& gt = source->geoTransform;
+    vsg::dvec2 topLeft = fromProjected(vsg::dvec2(gt[0], gt[3]));
+    vsg::dvec2 bottomRight = fromProjected(vsg::dvec2(gt[0] + gt[1] * double(source->width), gt[3] + gt[5] * double(source->height)));
+    vsg::dbox bounds;
+    bounds.min = vsg::dvec3(std::min(topLeft.x, bottomRight.x), std::min(topLeft.y, bottomRight.y), 0.0);
+    bounds.max = vsg::dvec3(std::max(topLeft.x, bottomRight.x), std::max(topLeft.y, bottomRight.y), 1.0);
+
+    uint32_t topLevel = maxLevel;
+    if (topLevel == 0)
+    {
+        // pick the first level whose tile pixels are no larger than the pixels of the sources
+        double levelZeroPixelSize = (toProjected(vsg::dvec2(settings->extents.max.x, 0.0)).x - toProjected(vsg::dvec2(settings->extents.min.x, 0.0)).x) / double(settings->noX * tileSize);
+        double sourcePixelSize = std::abs(gt[1]);
+        if (levelZeroPixelSize > sourcePixelSize) topLevel = static_cast<uint32_t>(std::ceil(std::log2(levelZeroPixelSize / sourcePixelSize)));
+    }
+    topLevel = std::min(topLevel, settings->maxLevel);
+
+    numTilesWritten = 0;
+
+    for (uint32_t level = topLevel + 1; level-- > 0;)
+    {
+        auto range = computeTileRange(bounds, level);
+        if (range.empty()) continue;
+
+        uint32_t numX = range.maxX - range.minX + 1;
+        uint64_t numTiles = uint64_t(numX) * uint64_t(range.maxY - range.minY + 1);
+        uint64_t numTilesBefore = numTilesWritten;
+
+        std::atomic_uint64_t nextTile{0};
+        std::atomic_bool failed{false};
+
+        auto build_tiles = [&](Source* threadSource) {
+            // the highest level is read from the sources, each thread needs its own GDAL handles as they aren't thread safe
+            std::unique_ptr<Source> ownSource;
+            if (level == topLevel && !threadSource)
+            {
+                ownSource = openSource(sources);
+                threadSource = ownSource.get();
+                if (!threadSource)
+                {
+                    failed = true;
+                    return;
+                }
+            }
+
+            for (uint64_t i = nextTile++; i < numTiles && !failed; i = nextTile++)
+            {
+                uint32_t x = range.minX + static_cast<uint32_t>(i % numX);
+                uint32_t y = range.minY + static_cast<uint32_t>(i / numX);
+
+                auto tile = (level == topLevel) ? readTile(*threadSource, x, y, level) : downsampleTile(x, y, level);
+                if (tile && !writeTile(tile, x, y, level)) failed = true;
+            }
+        };
+
+        // the calling thread reuses the source opened above, the additional threads open their own
+        uint32_t threadCount = static_cast<uint32_t>(std::clamp<uint64_t>(numThreads, 1, numTiles));
+        std::vector<std::thread> threads;
+        for (uint32_t t = 1; t < threadCount; ++t)
+        {
+            threads.emplace_back(build_tiles, static_cast<Source*>(nullptr));
+        }
+        build_tiles(source.get());
+
+        for (auto& thread : threads) thread.join();
+
+        if (failed) return false;
+
+        vsg::info("PyramidBuilder level ", level, " written ", numTilesWritten - numTilesBefore, " of ", numTiles, " tiles.");
+    }
+
+    settings->maxLevel = topLevel;
+    if (mipmapLevels > 1) settings->mipmapLevelsHint = computeNumMipmaps(tileSize, tileSize, mipmapLevels, minMipmapSize);
+
+    return true;
+}
@@ -0,0 +1,305 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/RasterTileLayer.h>
+
+#include <vsg/io/Logger.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace vsgGIS;
+
+// radius of the sphere used by EPSG:3857
+static constexpr double mercatorRadius = 6378137.0;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  RasterTileLayer
+//
+
+// the GDAL handles used by one thread at a time, declared so that the warped VRT is closed before the dataset it references
+struct RasterTileLayer::Handle
+{
+    std::shared_ptr<GDALDataset> dataset;
+    std::shared_ptr<GDALDataset> warped;
+    GDALDataset* source = nullptr;
+    double geoTransform[6];
+    int width = 0;
+    int height = 0;
+};
+
+RasterTileLayer::RasterTileLayer(const vsg::Path& in_filename, vsg::ref_ptr<const TileDatabaseSettings> in_settings, uint32_t in_tileSize, GDALResampleAlg in_resampleAlg) :
+    filename(in_filename),
+    settings(in_settings),
+    tileSize(in_tileSize),
+    resampleAlg(in_resampleAlg)
+{
+    initGDAL();
+
+    bool mercator = settings->projection == "EPSG:3857" || settings->projection == "spherical-mercator";
+
+    OGRSpatialReference targetSRS;
+    if (targetSRS.SetFromUserInput(mercator ? "EPSG:3857" : "EPSG:4326") != OGRERR_NONE) return;
+
+    char* wkt = nullptr;
+    targetSRS.exportToWkt(&wkt);
+    targetWKT = wkt ? wkt : "";
+    CPLFree(wkt);
+
+    auto dataset = openDataSet(filename, GA_ReadOnly);
+    if (!dataset)
+    {
+        vsg::warn("RasterTileLayer unable to open ", filename);
+        return;
+    }
+
+    // rasters without a projection are assumed to already be in the settings projection
+    const char* projectionRef = dataset->GetProjectionRef();
+    if (projectionRef && *projectionRef)
+    {
+        OGRSpatialReference sourceSRS;
+        reproject = sourceSRS.importFromWkt(projectionRef) != OGRERR_NONE || !sourceSRS.IsSame(&targetSRS);
+    }
+
+    auto types = dataTypes(*dataset);
+    int count = std::min(dataset->GetRasterCount(), 4);
+    if (types.size() != 1 || count == 0)
+    {
+        vsg::warn("RasterTileLayer ", filename, " requires 1 to 4 raster bands of a single data type.");
+        return;
+    }
+
+    dataType = *types.begin();
+    numComponents = (count == 3) ? 4 : count;
+    if (!createImage2D(1, 1, numComponents, dataType))
+    {
+        vsg::warn("RasterTileLayer ", filename, " unsupported data type ", GDALGetDataTypeName(dataType));
+        return;
+    }
+
+    numBands = count;
+
+    // keep the handle used to inspect the raster as the first handle of the pool
+    auto handle = openHandle();
+    if (handle)
+    {
+        _available.push_back(std::move(handle));
+        _numHandles = 1;
+    }
+    else
+    {
+        numBands = 0;
+    }
+}
+
+RasterTileLayer::~RasterTileLayer()
+{
+}
+
+bool RasterTileLayer::isRasterLayer(const vsg::Path& layer)
+{
+    return layer.string().compare(0, std::char_traits<char>::length(prefix), prefix) == 0;
+}
+
+vsg::Path RasterTileLayer::rasterFilename(const vsg::Path& layer)
+{
+    return isRasterLayer(layer) ? vsg::Path(layer.string().substr(std::char_traits<char>::length(prefix))) : layer;
+}
+
+size_t RasterTileLayer::numHandles() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _numHandles;
+}
+
+std::unique_ptr<RasterTileLayer::Handle> RasterTileLayer::openHandle() const
+{
+    auto handle = std::make_unique<Handle>();
+    handle->dataset = openDataSet(filename, GA_ReadOnly);
+    if (!handle->dataset) return {};
+
+    handle->source = handle->dataset.get();
+    if (reproject)
+    {
+        handle->warped = std::shared_ptr<GDALDataset>(static_cast<GDALDataset*>(GDALAutoCreateWarpedVRT(handle->dataset.get(), nullptr, targetWKT.c_str(), resampleAlg, 0.125, nullptr)), [](GDALDataset* dataset) { GDALClose(dataset); });
+        if (!handle->warped)
+        {
+            vsg::warn("RasterTileLayer unable to reproject ", filename, " to ", settings->projection);
+            return {};
+        }
+        handle->source = handle->warped.get();
+    }
+
+    if (handle->source->GetGeoTransform(handle->geoTransform) != CE_None)
+    {
+        vsg::warn("RasterTileLayer ", filename, " has no geo transform.");
+        return {};
+    }
+
+    handle->width = handle->source->GetRasterXSize();
+    handle->height = handle->source->GetRasterYSize();
+    return handle;
+}
+
+std::unique_ptr<RasterTileLayer::Handle> RasterTileLayer::acquireHandle()
+{
+    {
+        std::scoped_lock<std::mutex> lock(_mutex);
+        if (!_available.empty())
+        {
+            auto handle = std::move(_available.back());
+            _available.pop_back();
+            return handle;
+        }
+    }
+
+    // opening can be slow, particularly for remote rasters, so is done outside the lock
+    auto handle = openHandle();
+    if (handle)
+    {
+        std::scoped_lock<std::mutex> lock(_mutex);
+        ++_numHandles;
+    }
+    return handle;
+}
+
+void RasterTileLayer::releaseHandle(std::unique_ptr<Handle> handle)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    _available.push_back(std::move(handle));
+}
+
+int RasterTileLayer::selectOverview(GDALRasterBand& band, double decimation) const
+{
+    int selected = -1;
+    double selectedRatio = 1.0;
+    for (int i = 0; i < band.GetOverviewCount(); ++i)
+    {
+        auto overview = band.GetOverview(i);
+        if (!overview || overview->GetXSize() <= 0) continue;
+
+        double ratio = double(band.GetXSize()) / double(overview->GetXSize());
+        if (ratio <= decimation && ratio > selectedRatio)
+        {
+            selected = i;
+            selectedRatio = ratio;
+        }
+    }
+    return selected;
+}
+
+vsg::ref_ptr<vsg::Data> RasterTileLayer::read(uint32_t x, uint32_t y, uint32_t level)
+{
+    if (!valid()) return {};
+
+    auto tile = createImage2D(tileSize, tileSize, numComponents, dataType, vsg::dvec4(0.0, 0.0, 0.0, 1.0));
+    if (!tile) return {};
+
+    auto handle = acquireHandle();
+    if (!handle) return {};
+
+    // window of the tile in the pixel coordinates of the source, the TileReader maps the y extents of +/-90 onto the full +/-PI range of spherical mercator
+    auto tile_extents = settings->computeTileExtents(x, y, level);
+    auto toProjected = [&](double px, double py) {
+        if (settings->projection == "EPSG:3857" || settings->projection == "spherical-mercator")
+            return vsg::dvec2(vsg::radians(px) * mercatorRadius, 2.0 * vsg::radians(py) * mercatorRadius);
+        else
+            return vsg::dvec2(px, py);
+    };
+
+    auto& gt = handle->geoTransform;
+    vsg::dvec2 topLeft = toProjected(tile_extents.min.x, tile_extents.max.y);
+    vsg::dvec2 bottomRight = toProjected(tile_extents.max.x, tile_extents.min.y);
+    double px0 = (topLeft.x - gt[0]) / gt[1];
+    double px1 = (bottomRight.x - gt[0]) / gt[1];
+    double py0 = (topLeft.y - gt[3]) / gt[5];
+    double py1 = (bottomRight.y - gt[3]) / gt[5];
+    double scaleX = (px1 - px0) / double(tileSize);
+    double scaleY = (py1 - py0) / double(tileSize);
+
+    // clip the window to the source, the overlap is read into the corresponding part of the tile
+    double cx0 = std::max(px0, 0.0);
+    double cx1 = std::min(px1, double(handle->width));
+    double cy0 = std::max(py0, 0.0);
+    double cy1 = std::min(py1, double(handle->height));
+
+    auto bufferIndex = [&](double value) { return static_cast<int>(std::clamp(std::round(value), 0.0, double(tileSize))); };
+    int bx0 = bufferIndex((cx0 - px0) / scaleX);
+    int bx1 = bufferIndex((cx1 - px0) / scaleX);
+    int by0 = bufferIndex((cy0 - py0) / scaleY);
+    int by1 = bufferIndex((cy1 - py0) / scaleY);
+
+    bool success = true;
+    if (cx1 > cx0 && cy1 > cy0 && bx1 > bx0 && by1 > by0)
+    {
+        // every band has the same overviews so select the level once, from the source pixels covered by each tile pixel
+        int overview = selectOverview(*handle->source->GetRasterBand(1), std::min(scaleX, scaleY));
+
+        GSpacing pixelSpace = tile->getLayout().stride;
+        GSpacing lineSpace = pixelSpace * tileSize;
+        int componentSize = GDALGetDataTypeSizeBytes(dataType);
+        uint8_t* ptr = static_cast<uint8_t*>(tile->dataPointer(size_t(by0) * tileSize + size_t(bx0)));
+
+        for (int b = 1; b <= numBands && success; ++b)
+        {
+            GDALRasterBand* band = handle->source->GetRasterBand(b);
+            if (overview >= 0) band = band->GetOverview(overview);
+            if (!band)
+            {
+                success = false;
+                break;
+            }
+
+            // map the window onto the pixels of the overview
+            double ovScaleX = double(band->GetXSize()) / double(handle->width);
+            double ovScaleY = double(band->GetYSize()) / double(handle->height);
+
+            GDALRasterIOExtraArg extraArg;
+            INIT_RASTERIO_EXTRA_ARG(extraArg);
+            extraArg.eResampleAlg = (resampleAlg == GRA_NearestNeighbour) ? GRIORA_NearestNeighbour : GRIORA_Bilinear;
+            extraArg.bFloatingPointWindowValidity = TRUE;
+            extraArg.dfXOff = cx0 * ovScaleX;
+            extraArg.dfYOff = cy0 * ovScaleY;
+            extraArg.dfXSize = (cx1 - cx0) * ovScaleX;
+            extraArg.dfYSize = (cy1 - cy0) * ovScaleY;
+
+            int xOffset = static_cast<int>(std::floor(extraArg.dfXOff));
+            int yOffset = static_cast<int>(std::floor(extraArg.dfYOff));
+            int xSize = std::max(std::min(static_cast<int>(std::ceil(extraArg.dfXOff + extraArg.dfXSize)), band->GetXSize()) - xOffset, 1);
+            int ySize = std::max(std::min(static_cast<int>(std::ceil(extraArg.dfYOff + extraArg.dfYSize)), band->GetYSize()) - yOffset, 1);
+
+            success = band->RasterIO(GF_Read, xOffset, yOffset, xSize, ySize, ptr + (b - 1) * componentSize, bx1 - bx0, by1 - by0, dataType, pixelSpace, lineSpace, &extraArg) == CE_None;
+        }
+    }
+
+    releaseHandle(std::move(handle));
+
+    if (!success)
+    {
+        vsg::warn("RasterTileLayer unable to read tile ", x, " ", y, " ", level, " from ", filename);
+        return {};
+    }
+
+    return tile;
+}
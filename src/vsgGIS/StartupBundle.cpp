@@ -0,0 +1,73 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/StartupBundle.h>
+
+#include <vsg/io/Input.h>
+#include <vsg/io/ObjectFactory.h>
+#include <vsg/io/Output.h>
+
+using namespace vsgGIS;
+
+// Register the StartupBundle class with vsg::ObjectFactory::instance() so it can be used for creating objects during reading.
+vsg::RegisterWithObjectFactoryProxy<vsgGIS::StartupBundle> s_Register_StartupBundle;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  StartupBundle
+//
+void StartupBundle::read(vsg::Input& input)
+{
+    input.read("gpuTerrainDisplacement", gpuTerrainDisplacement);
+    input.read("textureArrays", textureArrays);
+    input.readObject("vertexShader", vertexShader);
+    input.readObject("fragmentShader", fragmentShader);
+
+    uint32_t numRootTiles = 0;
+    input.read("numRootTiles", numRootTiles);
+
+    rootImages.resize(numRootTiles);
+    rootTerrains.resize(numRootTiles);
+    for (uint32_t i = 0; i < numRootTiles; ++i)
+    {
+        input.readObject("image", rootImages[i]);
+        input.readObject("terrain", rootTerrains[i]);
+    }
+}
+
+void StartupBundle::write(vsg::Output& output) const
+{
+    output.write("gpuTerrainDisplacement", gpuTerrainDisplacement);
+    output.write("textureArrays", textureArrays);
+    output.writeObject("vertexShader", vertexShader);
+    output.writeObject("fragmentShader", fragmentShader);
+
+    // the terrains are written alongside the images, null where there is no terrainLayer
+    uint32_t numRootTiles = static_cast<uint32_t>(rootImages.size());
+    output.write("numRootTiles", numRootTiles);
+    for (uint32_t i = 0; i < numRootTiles; ++i)
+    {
+        output.writeObject("image", rootImages[i]);
+        output.writeObject("terrain", i < rootTerrains.size() ? rootTerrains[i] : vsg::ref_ptr<vsg::Data>());
+    }
+}
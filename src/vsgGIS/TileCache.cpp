@@ -0,0 +1,396 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/MappedTile.h>
+#include <vsgGIS/TileCache.h>
+
+#include <vsg/io/Logger.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace vsgGIS;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  TileCache
+//
+namespace
+{
+    // FNV-1a hash of the layer template, used to give each layer a stable directory name across sessions
+    std::string layerKey(const vsg::Path& layer)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (auto c : layer.string())
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        std::ostringstream str;
+        str << std::hex << hash;
+        return str.str();
+    }
+} // namespace
+
+TileCache::TileCache(const vsg::Path& in_path, uint64_t in_maxSize, double in_expiryTime) :
+    path(in_path),
+    maxSize(in_maxSize),
+    expiryTime(in_expiryTime),
+    _readerWriter(MappedTileReaderWriter::create())
+{
+    scan();
+}
+
+vsg::Path TileCache::getTileFilename(const vsg::Path& layer, uint32_t x, uint32_t y, uint32_t level) const
+{
+    auto filename = std::filesystem::path(path.string()) / layerKey(layer) / std::to_string(level) / std::to_string(x) / (std::to_string(y) + ".vsgm");
+    return vsg::Path(filename.string());
+}
+
+void TileCache::scan()
+{
+    std::error_code ec;
+    std::filesystem::path root(path.string());
+    if (!std::filesystem::is_directory(root, ec)) return;
+
+    // order the tiles already on disk by when they were written, so that the oldest are evicted first
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+    std::vector<std::filesystem::path> staleFiles;
+    for (auto& entry : std::filesystem::recursive_directory_iterator(root, ec))
+    {
+        if (!entry.is_regular_file(ec)) continue;
+
+        if (entry.path().extension() == ".vsgm")
+            files.emplace_back(entry.last_write_time(ec), entry.path());
+        else if (entry.path().extension() == ".vsgb")
+            staleFiles.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+
+    // tiles cached as .vsgb by earlier versions are no longer read
+    for (auto& file : staleFiles) std::filesystem::remove(file, ec);
+
+    std::scoped_lock<std::mutex> lock(_mutex);
+    for (auto& [time, file] : files)
+    {
+        uint64_t fileSize = std::filesystem::file_size(file, ec);
+        if (ec) continue;
+
+        vsg::Path filename(file.string());
+        _entries[filename.string()] = Entry{fileSize, _leastRecentlyUsed.insert(_leastRecentlyUsed.end(), filename), ++_generation};
+        _size += fileSize;
+    }
+
+    vsg::debug("TileCache::scan() ", path.string(), " ", _entries.size(), " tiles, ", _size, " bytes");
+
+    evict();
+}
+
+uint64_t TileCache::size() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _size;
+}
+
+vsg::ref_ptr<vsg::Data> TileCache::read(const vsg::Path& layer, uint32_t x, uint32_t y, uint32_t level)
+{
+    auto filename = getTileFilename(layer, x, y, level);
+
+    uint64_t generation = 0;
+    {
+        std::scoped_lock<std::mutex> lock(_mutex);
+        auto itr = _entries.find(filename.string());
+        if (itr == _entries.end()) return {};
+
+        if (expiryTime > 0.0)
+        {
+            std::error_code ec;
+            auto age = std::filesystem::file_time_type::clock::now() - std::filesystem::last_write_time(filename.string(), ec);
+            if (ec || std::chrono::duration<double>(age).count() > expiryTime)
+            {
+                remove(filename);
+                return {};
+            }
+        }
+
+        // mark as most recently used
+        _leastRecentlyUsed.splice(_leastRecentlyUsed.end(), _leastRecentlyUsed, itr->second.position);
+        generation = itr->second.generation;
+    }
+
+    auto data = _readerWriter->read_cast<vsg::Data>(filename);
+    if (!data)
+    {
+        // unreadable, so stop it being returned again, unless another thread has replaced it since the read began
+        std::scoped_lock<std::mutex> lock(_mutex);
+        auto itr = _entries.find(filename.string());
+        if (itr != _entries.end() && itr->second.generation == generation) remove(filename);
+    }
+    return data;
+}
+
+bool TileCache::write(const vsg::Path& layer, uint32_t x, uint32_t y, uint32_t level, vsg::ref_ptr<vsg::Data> data)
+{
+    if (!data) return false;
+
+    auto filename = getTileFilename(layer, x, y, level);
+    auto file = std::filesystem::path(filename.string());
+
+    std::error_code ec;
+    std::filesystem::create_directories(file.parent_path(), ec);
+
+    // write to a temporary file and rename so that other threads and sessions never see a partially written tile
+    auto temporaryFile = file;
+    temporaryFile += vsg::make_string(".", std::hash<std::thread::id>()(std::this_thread::get_id()), ".tmp");
+    if (!_readerWriter->write(data, vsg::Path(temporaryFile.string())))
+    {
+        std::filesystem::remove(temporaryFile, ec);
+        return false;
+    }
+
+    uint64_t fileSize = std::filesystem::file_size(temporaryFile, ec);
+
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    std::filesystem::rename(temporaryFile, file, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temporaryFile, ec);
+        return false;
+    }
+
+    if (auto itr = _entries.find(filename.string()); itr != _entries.end())
+    {
+        _size -= itr->second.size;
+        _leastRecentlyUsed.erase(itr->second.position);
+        _entries.erase(itr);
+    }
+
+    _entries[filename.string()] = Entry{fileSize, _leastRecentlyUsed.insert(_leastRecentlyUsed.end(), filename), ++_generation};
+    _size += fileSize;
+
+    evict();
+
+    return true;
+}
+
+void TileCache::remove(const vsg::Path& filename)
+{
+    auto itr = _entries.find(filename.string());
+    if (itr == _entries.end()) return;
+
+    std::error_code ec;
+    std::filesystem::remove(filename.string(), ec);
+
+    _size -= itr->second.size;
+    _leastRecentlyUsed.erase(itr->second.position);
+    _entries.erase(itr);
+}
+
+void TileCache::evict()
+{
+    if (maxSize == 0) return;
+
+    while (_size > maxSize && !_leastRecentlyUsed.empty())
+    {
+        auto filename = _leastRecentlyUsed.front();
+        remove(filename);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MemoryTileCache
+//
+MemoryTileCache::MemoryTileCache(uint64_t in_maxSize) :
+    maxSize(in_maxSize)
+{
+}
+
+vsg::ref_ptr<vsg::Object> MemoryTileCache::get(const std::string& key, uint32_t x, uint32_t y, uint32_t level)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    auto itr = _entries.find(Key{key, x, y, level});
+    if (itr == _entries.end())
+    {
+        ++_numMisses;
+        return {};
+    }
+
+    ++_numHits;
+
+    // mark as most recently used
+    _leastRecentlyUsed.splice(_leastRecentlyUsed.end(), _leastRecentlyUsed, itr->second.position);
+
+    return itr->second.object;
+}
+
+vsg::ref_ptr<vsg::Object> MemoryTileCache::take(const std::string& key, uint32_t x, uint32_t y, uint32_t level)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    auto itr = _entries.find(Key{key, x, y, level});
+    if (itr == _entries.end())
+    {
+        ++_numMisses;
+        return {};
+    }
+
+    ++_numHits;
+
+    auto object = itr->second.object;
+    _size -= itr->second.size;
+    _leastRecentlyUsed.erase(itr->second.position);
+    _entries.erase(itr);
+
+    return object;
+}
+
+void MemoryTileCache::insert(const std::string& key, uint32_t x, uint32_t y, uint32_t level, vsg::ref_ptr<vsg::Object> object, uint64_t size)
+{
+    if (!object || size > maxSize) return;
+
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    Key tileKey{key, x, y, level};
+    if (auto itr = _entries.find(tileKey); itr != _entries.end())
+    {
+        _size -= itr->second.size;
+        _leastRecentlyUsed.erase(itr->second.position);
+        _entries.erase(itr);
+    }
+
+    _entries[tileKey] = Entry{object, size, _leastRecentlyUsed.insert(_leastRecentlyUsed.end(), tileKey)};
+    _size += size;
+
+    evict();
+}
+
+void MemoryTileCache::evict()
+{
+    while (_size > maxSize && !_leastRecentlyUsed.empty())
+    {
+        auto itr = _entries.find(_leastRecentlyUsed.front());
+        _size -= itr->second.size;
+        _entries.erase(itr);
+        _leastRecentlyUsed.pop_front();
+    }
+}
+
+uint64_t MemoryTileCache::size() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _size;
+}
+
+uint64_t MemoryTileCache::numHits() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _numHits;
+}
+
+uint64_t MemoryTileCache::numMisses() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _numMisses;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  FetchBackoff
+//
+FetchBackoff::FetchBackoff(double in_initialDelay, double in_maxDelay, uint32_t in_maxRetries) :
+    initialDelay(in_initialDelay),
+    maxDelay(in_maxDelay),
+    maxRetries(in_maxRetries)
+{
+}
+
+bool FetchBackoff::ready(const std::string& layer, uint32_t x, uint32_t y, uint32_t level)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    auto itr = _entries.find(Key{layer, x, y, level});
+    if (itr == _entries.end() || std::chrono::steady_clock::now() >= itr->second.retryTime) return true;
+
+    ++_numSkipped;
+    return false;
+}
+
+double FetchBackoff::record(const std::string& layer, uint32_t x, uint32_t y, uint32_t level, bool success)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    Key tileKey{layer, x, y, level};
+    if (success)
+    {
+        _entries.erase(tileKey);
+        return 0.0;
+    }
+
+    prune();
+
+    auto& entry = _entries[tileKey];
+    double delay = (entry.numFailures < maxRetries) ? std::min(initialDelay * std::pow(2.0, double(entry.numFailures)), maxDelay) : maxDelay;
+    ++entry.numFailures;
+    entry.retryTime = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(delay));
+
+    return delay;
+}
+
+void FetchBackoff::prune()
+{
+    if (_entries.size() < _pruneSize) return;
+
+    // a tile the pager still wants is fetched again soon after its backoff elapses, so a record left a maxDelay past that is for a tile no longer requested,
+    // such as one out of the layer's coverage that has been scrolled past. Pruning is repeated as the map doubles so its cost is amortized over the failures.
+    auto expiredTime = std::chrono::steady_clock::now() - std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(maxDelay));
+    for (auto itr = _entries.begin(); itr != _entries.end();)
+    {
+        if (itr->second.retryTime < expiredTime)
+            itr = _entries.erase(itr);
+        else
+            ++itr;
+    }
+
+    _pruneSize = std::max(_entries.size() * 2, minPruneSize);
+}
+
+size_t FetchBackoff::numFailedTiles() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+uint64_t FetchBackoff::numSkipped() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _numSkipped;
+}
@@ -0,0 +1,154 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/TileDataPool.h>
+
+using namespace vsgGIS;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  TileDataPool
+//
+TileDataPool::TileDataPool(uint64_t in_maxSize) :
+    maxSize(in_maxSize)
+{
+}
+
+vsg::ref_ptr<vsg::Data> TileDataPool::acquire(size_t size)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    ++_numAcquired;
+
+    // search from after the last block handed out as the blocks before it are the most likely to still be in use
+    auto& pool = _pools[size];
+    for (size_t i = 0; i < pool.blocks.size(); ++i)
+    {
+        size_t index = (pool.next + i) % pool.blocks.size();
+        if (pool.blocks[index]->referenceCount() == 1)
+        {
+            pool.next = index + 1;
+            ++_numReused;
+            return pool.blocks[index];
+        }
+    }
+
+    vsg::ref_ptr<vsg::Data> block = vsg::ubyteArray::create(static_cast<uint32_t>(size));
+
+    if (maxSize > 0 && _size + size > maxSize) release(_size + size - maxSize, size);
+
+    if (maxSize == 0 || _size + size <= maxSize)
+    {
+        pool.blocks.push_back(block);
+        _size += size;
+    }
+    else
+    {
+        // the pool is full of blocks in use, hand out a block that is freed as normal
+        ++_numUnpooled;
+    }
+
+    return block;
+}
+
+uint64_t TileDataPool::release(size_t required, size_t exclude)
+{
+    uint64_t released = 0;
+    for (auto pool_itr = _pools.begin(); pool_itr != _pools.end() && released < required;)
+    {
+        auto& [blockSize, pool] = *pool_itr;
+        if (blockSize != exclude)
+        {
+            for (auto itr = pool.blocks.begin(); itr != pool.blocks.end() && released < required;)
+            {
+                if ((*itr)->referenceCount() == 1)
+                {
+                    itr = pool.blocks.erase(itr);
+                    released += blockSize;
+                }
+                else
+                {
+                    ++itr;
+                }
+            }
+            pool.next = 0;
+        }
+
+        if (pool.blocks.empty() && blockSize != exclude)
+            pool_itr = _pools.erase(pool_itr);
+        else
+            ++pool_itr;
+    }
+
+    _size -= released;
+    return released;
+}
+
+uint64_t TileDataPool::trim()
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return release(_size, 0);
+}
+
+std::vector<TileDataPool::Occupancy> TileDataPool::occupancy() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    std::vector<Occupancy> pools;
+    for (auto& [blockSize, pool] : _pools)
+    {
+        Occupancy occupancy;
+        occupancy.blockSize = blockSize;
+        occupancy.numBlocks = static_cast<uint32_t>(pool.blocks.size());
+        for (auto& block : pool.blocks)
+        {
+            if (block->referenceCount() > 1) ++occupancy.numInUse;
+        }
+        pools.push_back(occupancy);
+    }
+    return pools;
+}
+
+uint64_t TileDataPool::size() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _size;
+}
+
+uint64_t TileDataPool::numAcquired() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _numAcquired;
+}
+
+uint64_t TileDataPool::numReused() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _numReused;
+}
+
+uint64_t TileDataPool::numUnpooled() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _numUnpooled;
+}
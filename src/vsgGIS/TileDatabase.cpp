@@ -1,8 +1,21 @@
+#include <vsgGIS/HorizonCullNode.h>
+#include <vsgGIS/MappedTile.h>
+#include <vsgGIS/RasterTileLayer.h>
 #include <vsgGIS/TileDatabase.h>
+#include <vsgGIS/ellipsoid_utils.h>
+#include <vsgGIS/texture_utils.h>
 
 #include <vsg/io/Logger.h>
 #include <vsg/io/Options.h>
 
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+#include "shaders/simple_tile_array_frag.cpp"
+#include "shaders/simple_tile_array_vert.cpp"
+#include "shaders/simple_tile_displace_array_vert.cpp"
+#include "shaders/simple_tile_displace_vert.cpp"
 #include "shaders/simple_tile_frag.cpp"
 #include "shaders/simple_tile_vert.cpp"
 
@@ -52,24 +65,151 @@ void TileDatabaseSettings::write(vsg::Output& output) const
     output.write("mipmapLevelsHint", mipmapLevelsHint);
 }
 
+void TileDatabaseSettings::readVersionedFields(vsg::Input& input, uint32_t version)
+{
+    if (version < 1) return;
+
+    input.read("numFetchThreads", numFetchThreads);
+    input.read("tileCachePath", tileCachePath);
+    input.read("tileCacheMaxSize", tileCacheMaxSize);
+    input.read("tileCacheExpiryTime", tileCacheExpiryTime);
+    input.read("memoryCacheMaxSize", memoryCacheMaxSize);
+    input.read("memoryCacheSubgraphs", memoryCacheSubgraphs);
+    input.read("gpuTerrainDisplacement", gpuTerrainDisplacement);
+    input.read("textureCompression", textureCompression);
+    input.read("textureArrays", textureArrays);
+    input.read("pagerTargetMaxNumPagedLODWithHighResSubgraphs", pagerTargetMaxNumPagedLODWithHighResSubgraphs);
+    input.read("maxResidentTiles", maxResidentTiles);
+    input.read("residentMemoryBudget", residentMemoryBudget);
+    input.read("tileDataPoolMaxSize", tileDataPoolMaxSize);
+    input.read("prioritizedLoading", prioritizedLoading);
+    input.read("prefetchTime", prefetchTime);
+    input.read("cancelScreenHeightRatio", cancelScreenHeightRatio);
+    input.read("fetchRetries", fetchRetries);
+    input.read("fetchRetryDelay", fetchRetryDelay);
+    input.read("fetchRetryMaxDelay", fetchRetryMaxDelay);
+    input.read("fillMissingSubtiles", fillMissingSubtiles);
+    input.read("rasterTileSize", rasterTileSize);
+    input.read("loadStatsTraceEvents", loadStatsTraceEvents);
+    input.read("horizonCulling", horizonCulling);
+    input.read("adaptiveGrid", adaptiveGrid);
+    input.read("gridMaxAngle", gridMaxAngle);
+    input.read("minGridSegments", minGridSegments);
+    input.read("maxGridSegments", maxGridSegments);
+    input.read("skirtRatio", skirtRatio);
+    input.read("uploadBytesPerFrame", uploadBytesPerFrame);
+    input.read("cpuMipmaps", cpuMipmaps);
+    input.read("minMipmapSize", minMipmapSize);
+    input.read("incrementalRefinement", incrementalRefinement);
+}
+
+void TileDatabaseSettings::writeVersionedFields(vsg::Output& output) const
+{
+    output.write("numFetchThreads", numFetchThreads);
+    output.write("tileCachePath", tileCachePath);
+    output.write("tileCacheMaxSize", tileCacheMaxSize);
+    output.write("tileCacheExpiryTime", tileCacheExpiryTime);
+    output.write("memoryCacheMaxSize", memoryCacheMaxSize);
+    output.write("memoryCacheSubgraphs", memoryCacheSubgraphs);
+    output.write("gpuTerrainDisplacement", gpuTerrainDisplacement);
+    output.write("textureCompression", textureCompression);
+    output.write("textureArrays", textureArrays);
+    output.write("pagerTargetMaxNumPagedLODWithHighResSubgraphs", pagerTargetMaxNumPagedLODWithHighResSubgraphs);
+    output.write("maxResidentTiles", maxResidentTiles);
+    output.write("residentMemoryBudget", residentMemoryBudget);
+    output.write("tileDataPoolMaxSize", tileDataPoolMaxSize);
+    output.write("prioritizedLoading", prioritizedLoading);
+    output.write("prefetchTime", prefetchTime);
+    output.write("cancelScreenHeightRatio", cancelScreenHeightRatio);
+    output.write("fetchRetries", fetchRetries);
+    output.write("fetchRetryDelay", fetchRetryDelay);
+    output.write("fetchRetryMaxDelay", fetchRetryMaxDelay);
+    output.write("fillMissingSubtiles", fillMissingSubtiles);
+    output.write("rasterTileSize", rasterTileSize);
+    output.write("loadStatsTraceEvents", loadStatsTraceEvents);
+    output.write("horizonCulling", horizonCulling);
+    output.write("adaptiveGrid", adaptiveGrid);
+    output.write("gridMaxAngle", gridMaxAngle);
+    output.write("minGridSegments", minGridSegments);
+    output.write("maxGridSegments", maxGridSegments);
+    output.write("skirtRatio", skirtRatio);
+    output.write("uploadBytesPerFrame", uploadBytesPerFrame);
+    output.write("cpuMipmaps", cpuMipmaps);
+    output.write("minMipmapSize", minMipmapSize);
+    output.write("incrementalRefinement", incrementalRefinement);
+}
+
+vsg::dbox TileDatabaseSettings::computeTileExtents(uint32_t x, uint32_t y, uint32_t level) const
+{
+    double multiplier = pow(0.5, double(level));
+    double tileWidth = multiplier * (extents.max.x - extents.min.x) / double(noX);
+    double tileHeight = multiplier * (extents.max.y - extents.min.y) / double(noY);
+
+    vsg::dbox tile_extents;
+    if (originTopLeft)
+    {
+        vsg::dvec3 origin(extents.min.x, extents.max.y, extents.min.z);
+        tile_extents.min = origin + vsg::dvec3(double(x) * tileWidth, -double(y + 1) * tileHeight, 0.0);
+        tile_extents.max = origin + vsg::dvec3(double(x + 1) * tileWidth, -double(y) * tileHeight, 1.0);
+    }
+    else
+    {
+        tile_extents.min = extents.min + vsg::dvec3(double(x) * tileWidth, double(y) * tileHeight, 0.0);
+        tile_extents.max = extents.min + vsg::dvec3(double(x + 1) * tileWidth, double(y + 1) * tileHeight, 1.0);
+    }
+    return tile_extents;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 //  TileDatabase
 //
+TileDatabase::TileDatabase()
+{
+    setValue("SettingsVersion", TileDatabaseSettings::formatVersion);
+}
+
 void TileDatabase::read(vsg::Input& input)
 {
+    // databases written before the settings were versioned have no "SettingsVersion" user value
+    setValue("SettingsVersion", uint32_t(0));
+
     Node::read(input);
 
+    uint32_t settingsVersion = 0;
+    getValue("SettingsVersion", settingsVersion);
+
     input.readObject("settings", settings);
+    if (settingsVersion >= 1)
+    {
+        if (settings) settings->readVersionedFields(input, settingsVersion);
+        input.readObject("startupBundle", startupBundle);
+    }
+
+    // written back out in the current layout
+    setValue("SettingsVersion", TileDatabaseSettings::formatVersion);
 
     readDatabase(input.options);
 }
 
+void TileDatabase::traverse(vsg::RecordTraversal& visitor) const
+{
+    // each frame recorded opens a new upload budget for the tiles being paged in
+    if (tileReader && tileReader->uploadBudget)
+    {
+        if (auto frameStamp = visitor.getFrameStamp()) tileReader->uploadBudget->advanceFrame(frameStamp->frameCount);
+    }
+
+    t_traverse(*this, visitor);
+}
+
 void TileDatabase::write(vsg::Output& output) const
 {
     Node::write(output);
 
     output.writeObject("settings", settings);
+    if (settings) settings->writeVersionedFields(output);
+    output.writeObject("startupBundle", startupBundle);
 }
 
 bool TileDatabase::readDatabase(vsg::ref_ptr<const vsg::Options> options)
@@ -78,13 +218,17 @@ bool TileDatabase::readDatabase(vsg::ref_ptr<const vsg::Options> options)
 
     if (settings->ellipsoidModel) setObject("EllipsoidModel", settings->ellipsoidModel);
 
-    auto tileReader = TileReader::create();
+    tileReader = TileReader::create();
     tileReader->settings = settings;
+    tileReader->startupBundle = startupBundle;
     tileReader->init(options);
 
     auto local_options = options ? vsg::Options::create(*options) : vsg::Options::create();
     local_options->readerWriters.insert(local_options->readerWriters.begin(), tileReader);
 
+    // local tile pyramids written by vsggis as .vsgm are read in place by memory mapping them
+    local_options->readerWriters.insert(local_options->readerWriters.begin() + 1, MappedTileReaderWriter::create());
+
     child = vsg::read_cast<vsg::Node>("root.tile", local_options);
 
     return child.valid();
@@ -92,7 +236,166 @@ bool TileDatabase::readDatabase(vsg::ref_ptr<const vsg::Options> options)
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-//  TileDatabase
+//  FetchTile
+//
+// read of a single tile, run on one of the TileReader::fetchThreads, or the loadScheduler, so that many tiles can be in flight while meshes are being built
+struct TileReader::FetchTile : public vsg::Inherit<TileRequest, TileReader::FetchTile>
+{
+    FetchTile(const TileReader* in_tileReader, const vsg::Path& in_layer, vsg::ref_ptr<RasterTileLayer> in_rasterLayer, uint32_t in_x, uint32_t in_y, uint32_t in_level, vsg::ref_ptr<const vsg::Options> in_options) :
+        tileReader(in_tileReader),
+        layer(in_layer),
+        rasterLayer(in_rasterLayer),
+        x(in_x),
+        y(in_y),
+        path(in_tileReader->getTilePath(in_layer, in_x, in_y, in_level)),
+        options(in_options),
+        remote(in_layer.find("://") != vsg::Path::npos),
+        latch(vsg::Latch::create(1)),
+        queuedTime(std::chrono::steady_clock::now())
+    {
+        level = in_level;
+    }
+
+    vsg::ref_ptr<const TileReader> tileReader;
+    vsg::Path layer;
+    vsg::ref_ptr<RasterTileLayer> rasterLayer;
+    uint32_t x;
+    uint32_t y;
+    vsg::Path path;
+    vsg::ref_ptr<const vsg::Options> options;
+    bool remote;
+    vsg::ref_ptr<vsg::Latch> latch;
+    vsg::ref_ptr<vsg::Object> object;
+    bool cancelled = false;
+    bool backingOff = false;
+    std::chrono::steady_clock::time_point queuedTime;
+
+    void run() override
+    {
+        auto& stats = *tileReader->loadStats;
+        stats.add(TileLoadStats::FETCH_QUEUED, queuedTime, std::chrono::steady_clock::now());
+
+        // only remote layers are worth caching or retrying, local files are already on disk
+        auto memoryCache = tileReader->memoryCache.get();
+        auto tileCache = remote ? tileReader->tileCache.get() : nullptr;
+        auto backoff = remote ? tileReader->fetchBackoff.get() : nullptr;
+
+        // check the in memory and then on disk caches before going to the network
+        if (memoryCache)
+        {
+            object = memoryCache->get(layer.string(), x, y, level);
+            stats.increment(object ? TileLoadStats::MEMORY_CACHE_HIT : TileLoadStats::MEMORY_CACHE_MISS);
+        }
+
+        // siblings held back from a read of 4 subtiles that failed as one of them was backing off
+        if (!object && tileReader->heldSubtiles) object = tileReader->heldSubtiles->take(layer.string(), x, y, level);
+
+        if (!object)
+        {
+            if (tileCache)
+            {
+                auto start = std::chrono::steady_clock::now();
+                object = tileCache->read(layer, x, y, level);
+                stats.add(TileLoadStats::TILE_CACHE_READ, start, std::chrono::steady_clock::now());
+                stats.increment(object ? TileLoadStats::TILE_CACHE_HIT : TileLoadStats::TILE_CACHE_MISS);
+            }
+
+            // tiles that failed recently aren't fetched again until their backoff has elapsed, a failed fetch isn't retried on the fetch thread
+            // but by the pager's next request of the tile once its backoff allows
+            if (!object && backoff && !backoff->ready(layer.string(), x, y, level))
+            {
+                backingOff = true;
+            }
+            else if (!object)
+            {
+                auto start = std::chrono::steady_clock::now();
+                object = rasterLayer ? vsg::ref_ptr<vsg::Object>(rasterLayer->read(x, y, level)) : vsg::read(path, options);
+                stats.add(TileLoadStats::FETCH, start, std::chrono::steady_clock::now());
+
+                if (backoff)
+                {
+                    double delay = backoff->record(layer.string(), x, y, level, object.valid());
+                    if (!object) vsg::debug("FetchTile failed ", path, ", may be fetched again in ", delay, " seconds.");
+                    backingOff = !object;
+                }
+
+                if (auto data = object.cast<vsg::Data>())
+                    stats.addBytes(data->dataSize());
+                else
+                    stats.increment(TileLoadStats::FETCH_FAILED);
+
+                if (tileCache) tileCache->write(layer, x, y, level, object.cast<vsg::Data>());
+            }
+
+            auto data = object.cast<vsg::Data>();
+            if (memoryCache && data) memoryCache->insert(layer.string(), x, y, level, data, data->dataSize());
+        }
+
+        latch->count_down();
+    }
+
+    // dropped by the loadScheduler as the tile is no longer needed, release the waiting thread with no object
+    void cancel() override
+    {
+        cancelled = true;
+        latch->count_down();
+    }
+
+    // wait for the read to complete and return the result
+    template<class T>
+    vsg::ref_ptr<T> wait()
+    {
+        if (!latch->is_ready())
+        {
+            auto start = std::chrono::steady_clock::now();
+            latch->wait();
+            tileReader->loadStats->add(TileLoadStats::FETCH_WAIT, start, std::chrono::steady_clock::now());
+        }
+        return object.cast<T>();
+    }
+};
+
+// texture binding and terrain of a tile, held by the options of the tile's PagedLOD with settings->incrementalRefinement so the placeholders of its subtiles can be drawn with them
+struct TileReader::ParentTile : public vsg::Inherit<vsg::Object, TileReader::ParentTile>
+{
+    vsg::ref_ptr<vsg::StateCommand> bindDescriptorSets;
+    uint8_t origin = vsg::TOP_LEFT;
+    vsg::dbox extents;
+    vsg::ref_ptr<vsg::Data> terrain;
+};
+
+struct TileReader::TextureArrayBatch : public vsg::Inherit<vsg::Object, TileReader::TextureArrayBatch>
+{
+    std::vector<TextureArrayLayer> layers;
+    std::vector<vsg::ref_ptr<vsg::Node>> tiles;
+};
+
+namespace
+{
+    // attached to each tile so the TileReader's resident tile telemetry is updated when the tile is deleted.
+    // The TileReader is only observed as tiles held by its memoryCache would otherwise keep it alive.
+    struct ResidentTile : public vsg::Inherit<vsg::Object, ResidentTile>
+    {
+        ResidentTile(const TileReader* in_tileReader, uint64_t in_size) :
+            tileReader(vsg::ref_ptr<const TileReader>(in_tileReader)),
+            size(in_size)
+        {
+            in_tileReader->tileCreated(size);
+        }
+
+        ~ResidentTile()
+        {
+            if (auto reader = vsg::ref_ptr<const TileReader>(tileReader)) reader->tileReleased(size);
+        }
+
+        vsg::observer_ptr<const TileReader> tileReader;
+        uint64_t size;
+    };
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  TileReader
 //
 void TileReader::read(vsg::Input& input)
 {
@@ -122,23 +425,7 @@ vsg::dvec3 TileReader::computeLatitudeLongitudeAltitude(const vsg::dvec3& src) c
 
 vsg::dbox TileReader::computeTileExtents(uint32_t x, uint32_t y, uint32_t level) const
 {
-    double multiplier = pow(0.5, double(level));
-    double tileWidth = multiplier * (settings->extents.max.x - settings->extents.min.x) / double(settings->noX);
-    double tileHeight = multiplier * (settings->extents.max.y - settings->extents.min.y) / double(settings->noY);
-
-    vsg::dbox tile_extents;
-    if (settings->originTopLeft)
-    {
-        vsg::dvec3 origin(settings->extents.min.x, settings->extents.max.y, settings->extents.min.z);
-        tile_extents.min = origin + vsg::dvec3(double(x) * tileWidth, -double(y + 1) * tileHeight, 0.0);
-        tile_extents.max = origin + vsg::dvec3(double(x + 1) * tileWidth, -double(y) * tileHeight, 1.0);
-    }
-    else
-    {
-        tile_extents.min = settings->extents.min + vsg::dvec3(double(x) * tileWidth, double(y) * tileHeight, 0.0);
-        tile_extents.max = settings->extents.min + vsg::dvec3(double(x + 1) * tileWidth, double(y + 1) * tileHeight, 1.0);
-    }
-    return tile_extents;
+    return settings->computeTileExtents(x, y, level);
 }
 
 vsg::Path TileReader::getTilePath(const vsg::Path& src, uint32_t x, uint32_t y, uint32_t level) const
@@ -158,6 +445,98 @@ vsg::Path TileReader::getTilePath(const vsg::Path& src, uint32_t x, uint32_t y,
     return path;
 }
 
+vsg::ref_ptr<TileReader::FetchTile> TileReader::fetchTile(const vsg::Path& layer, uint32_t x, uint32_t y, uint32_t level, const vsg::dsphere& bound, bool prefetch, vsg::ref_ptr<const vsg::Options> options) const
+{
+    auto fetch = FetchTile::create(this, layer, (layer == settings->imageLayer) ? imageRasterLayer : terrainRasterLayer, x, y, level, options);
+    fetch->bound = bound;
+    fetch->prefetch = prefetch;
+
+    if (loadScheduler)
+        loadScheduler->add(fetch);
+    else if (fetchThreads)
+        fetchThreads->add(fetch);
+    else
+        fetch->run();
+    return fetch;
+}
+
+vsg::dsphere TileReader::computeTileBound(uint32_t x, uint32_t y, uint32_t level) const
+{
+    auto tile_extents = computeTileExtents(x, y, level);
+
+    auto toECEF = [&](double px, double py) {
+        auto lla = computeLatitudeLongitudeAltitude(vsg::dvec3(px, py, 0.0));
+        return settings->ellipsoidModel->convertLatLongAltitudeToECEF(lla);
+    };
+
+    vsg::dvec3 center = toECEF((tile_extents.min.x + tile_extents.max.x) * 0.5, (tile_extents.min.y + tile_extents.max.y) * 0.5);
+
+    // the edge midpoints are needed as well as the corners as the tiles of the coarse levels curve away from the chord between their corners
+    double radius = 0.0;
+    for (double fy : {0.0, 0.5, 1.0})
+    {
+        for (double fx : {0.0, 0.5, 1.0})
+        {
+            auto position = toECEF(tile_extents.min.x + fx * (tile_extents.max.x - tile_extents.min.x), tile_extents.min.y + fy * (tile_extents.max.y - tile_extents.min.y));
+            radius = std::max(radius, vsg::length(position - center));
+        }
+    }
+
+    return vsg::dsphere(center, radius);
+}
+
+vsg::ref_ptr<vsg::Node> TileReader::cullBehindHorizon(vsg::ref_ptr<vsg::Node> node, const TileBound* tileBound) const
+{
+    if (!settings->horizonCulling || !tileBound || !tileBound->hasHorizonOcclusionPoint) return node;
+
+    auto& ellipsoidModel = *settings->ellipsoidModel;
+    vsg::dvec3 radii(ellipsoidModel.radiusEquator(), ellipsoidModel.radiusEquator(), ellipsoidModel.radiusPolar());
+    return HorizonCullNode::create(radii, tileBound->horizonOcclusionPoint, node);
+}
+
+uint32_t TileReader::computeGridSegments(double span) const
+{
+    if (!settings->adaptiveGrid) return 31;
+
+    // the indices are 16 bit so the grids are limited to 128 x 128 quads
+    auto powerOfTwo = [](double value) {
+        uint32_t segments = 1;
+        while (double(segments) < value && segments < 128) segments *= 2;
+        return segments;
+    };
+
+    uint32_t minSegments = powerOfTwo(std::max(settings->minGridSegments, 2u));
+    uint32_t maxSegments = std::max(powerOfTwo(settings->maxGridSegments), minSegments);
+    uint32_t segments = settings->gridMaxAngle > 0.0 ? powerOfTwo(span / settings->gridMaxAngle) : maxSegments;
+
+    return std::clamp(segments, minSegments, maxSegments);
+}
+
+const TileReader::TileGrid& TileReader::selectGrid(const vsg::dbox& tile_extents, bool* matchParentEdges) const
+{
+    double span = std::max(tile_extents.max.x - tile_extents.min.x, tile_extents.max.y - tile_extents.min.y);
+    uint32_t segments = computeGridSegments(span);
+
+    // the parent level's tiles are twice the span, when they have as many quads along each edge the vertices of a tile's edge are twice as dense as a coarser neighbour's.
+    // The grids are powers of two so every other vertex coincides with the neighbour's, the rest have to be moved onto the neighbour's edge. That only holds while the
+    // neighbour's edge is drawn unmodified, so walking down from the root level a level is only matched when its parent isn't, the skirts close the edges of the others.
+    if (matchParentEdges)
+    {
+        *matchParentEdges = false;
+        if (settings->adaptiveGrid)
+        {
+            auto root_extents = computeTileExtents(0, 0, 0);
+            double rootSpan = std::max(root_extents.max.x - root_extents.min.x, root_extents.max.y - root_extents.min.y);
+            for (double levelSpan = rootSpan * 0.5; levelSpan > span * 0.75; levelSpan *= 0.5)
+            {
+                *matchParentEdges = !*matchParentEdges && computeGridSegments(levelSpan * 2.0) == computeGridSegments(levelSpan);
+            }
+        }
+    }
+
+    return tileGrids.at(segments);
+}
+
 vsg::ref_ptr<vsg::Object> TileReader::read(const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> options) const
 {
     auto extension = vsg::lowerCaseFileExtension(filename);
@@ -170,6 +549,10 @@ vsg::ref_ptr<vsg::Object> TileReader::read(const vsg::Path& filename, vsg::ref_p
     }
     else
     {
+        // "x y lod.refine.tile" reads the single tile that replaces its placeholder, see read_placeholders()
+        bool refine = vsg::lowerCaseFileExtension(tile_info) == ".refine";
+        if (refine) tile_info = tile_info.substr(0, tile_info.length() - 7);
+
         std::basic_stringstream<vsg::Path::value_type> sstr(tile_info);
 
         uint32_t x, y, lod;
@@ -177,60 +560,175 @@ vsg::ref_ptr<vsg::Object> TileReader::read(const vsg::Path& filename, vsg::ref_p
 
         vsg::debug("read(", filename, ") -> tile_info = ", tile_info, ", x = ", x, ", y = ", y, ", z = ", lod);
 
+        if (refine) return read_tile(x, y, lod, options);
+
         return read_subtile(x, y, lod, options);
     }
 }
 
+void TileReader::tileCreated(uint64_t size) const
+{
+    std::scoped_lock<std::mutex> lock(statsMutex);
+    ++numResidentTiles;
+    residentTileBytes += size;
+
+    if (numResidentTiles > peakNumResidentTiles)
+    {
+        // report the first time the preallocated resources are exceeded as the Vulkan pools will have to grow from then on
+        if (numPreallocatedTiles > 0 && peakNumResidentTiles == numPreallocatedTiles)
+        {
+            vsg::info("TileReader resident tiles exceeded the ", numPreallocatedTiles, " tiles preallocated by the ResourceHints.");
+        }
+        peakNumResidentTiles = numResidentTiles;
+    }
+}
+
+void TileReader::tileReleased(uint64_t size) const
+{
+    std::scoped_lock<std::mutex> lock(statsMutex);
+    --numResidentTiles;
+    residentTileBytes -= size;
+}
+
+uint32_t TileReader::computeMaxResidentTiles(uint64_t bytesPerTile) const
+{
+    // number of tiles in the whole database, which bounds the rest for shallow databases
+    double numTilesInDatabase = 0.0;
+    double numTilesInLevel = double(settings->noX * settings->noY);
+    for (uint32_t level = 0; level <= settings->maxLevel && numTilesInDatabase < 1e9; ++level)
+    {
+        numTilesInDatabase += numTilesInLevel;
+        numTilesInLevel *= 4.0;
+    }
+
+    // the pager expires high res subgraphs, of 4 tiles each, beyond its target so that along with the root tiles bounds the number of resident tiles
+    double maxTiles = settings->maxResidentTiles > 0 ? double(settings->maxResidentTiles) : double(settings->pagerTargetMaxNumPagedLODWithHighResSubgraphs) * 4.0 + double(settings->noX * settings->noY);
+
+    if (settings->residentMemoryBudget > 0 && bytesPerTile > 0)
+    {
+        maxTiles = std::min(maxTiles, double(settings->residentMemoryBudget / bytesPerTile));
+    }
+
+    return static_cast<uint32_t>(std::max(std::min(maxTiles, numTilesInDatabase), 1.0));
+}
+
 vsg::ref_ptr<vsg::Object> TileReader::read_root(vsg::ref_ptr<const vsg::Options> options) const
 {
     auto group = createRoot();
 
     uint32_t lod = 0;
+
+    // root tiles held by the startupBundle are built without fetching, the rest are paged in as placeholders unless textureArrays needs them all up front
+    uint32_t numTiles = settings->noX * settings->noY;
+    auto bundleImage = [&](uint32_t i) { return (startupBundle && i < startupBundle->rootImages.size()) ? startupBundle->rootImages[i] : vsg::ref_ptr<vsg::Data>(); };
+    auto bundleTerrain = [&](uint32_t i) { return (startupBundle && i < startupBundle->rootTerrains.size()) ? startupBundle->rootTerrains[i] : vsg::ref_ptr<vsg::Data>(); };
+    bool pageMissingTiles = startupBundle && !textureArrays;
+
+    // issue all the level 0 image and terrain reads up front so they are fetched concurrently
+    std::vector<vsg::ref_ptr<FetchTile>> imageFetches(numTiles);
+    std::vector<vsg::ref_ptr<FetchTile>> terrainFetches(numTiles);
+    for (uint32_t y = 0; y < settings->noY; ++y)
+    {
+        for (uint32_t x = 0; x < settings->noX; ++x)
+        {
+            uint32_t i = x + y * settings->noX;
+            if (bundleImage(i) || pageMissingTiles) continue;
+
+            // the root tiles are needed regardless of the view so aren't given a bound
+            vsg::dsphere bound(0.0, 0.0, 0.0, 0.0);
+
+            imageFetches[i] = fetchTile(settings->imageLayer, x, y, lod, bound, false, options);
+
+            if (!settings->terrainLayer.empty())
+            {
+                terrainFetches[i] = fetchTile(settings->terrainLayer, x, y, lod, bound, false, options);
+            }
+        }
+    }
+
+    auto rootImage = [&](uint32_t i) { return imageFetches[i] ? imageFetches[i]->wait<vsg::Data>() : bundleImage(i); };
+    auto rootTerrain = [&](uint32_t i) { return terrainFetches[i] ? terrainFetches[i]->wait<vsg::Data>() : bundleTerrain(i); };
+
+    // when batching textures all the tiles are needed up front so their images can be packed into shared texture arrays
+    std::vector<TextureArrayLayer> textureArrayLayers;
+    if (textureArrays)
+    {
+        vsg::DataList images, terrains;
+        for (uint32_t i = 0; i < numTiles; ++i)
+        {
+            images.push_back(rootImage(i));
+            terrains.push_back(rootTerrain(i));
+        }
+
+        for (auto& stateGroup : createTextureArrays(images, terrains, textureArrayLayers)) group->addChild(stateGroup);
+    }
+
     for (uint32_t y = 0; y < settings->noY; ++y)
     {
         for (uint32_t x = 0; x < settings->noX; ++x)
         {
-            auto imagePath = getTilePath(settings->imageLayer, x, y, lod);
-            //auto terrainPath = getTilePath(terrainLayer, x, y, lod);
+            uint32_t i = x + y * settings->noX;
+            auto imageTile = rootImage(i);
+            auto terrainTile = rootTerrain(i);
 
-            auto imageTile = vsg::read_cast<vsg::Data>(imagePath, options);
-            //auto terrainTile = vsg::read(terrainPath, options);
+            vsg::ref_ptr<vsg::Group> parent = group;
+            int32_t textureLayer = -1;
+            if (textureArrays)
+            {
+                if (!textureArrayLayers[i].stateGroup) continue;
+                parent = textureArrayLayers[i].stateGroup;
+                textureLayer = textureArrayLayers[i].layer;
+            }
 
             if (imageTile)
             {
                 auto tile_extents = computeTileExtents(x, y, lod);
-                auto tile = createTile(tile_extents, imageTile);
+                auto tile = createTile(tile_extents, imageTile, terrainTile, textureLayer);
                 if (tile)
                 {
-                    vsg::ComputeBounds computeBound;
-                    tile->accept(computeBound);
-                    auto& bb = computeBound.bounds;
-                    vsg::dsphere bound((bb.min.x + bb.max.x) * 0.5, (bb.min.y + bb.max.y) * 0.5, (bb.min.z + bb.max.z) * 0.5, vsg::length(bb.max - bb.min) * 0.5);
+                    auto tileBound = tile->getObject<TileBound>("TileBound");
+                    vsg::dsphere bound = tileBound ? tileBound->sphere : computeTileBound(x, y, lod);
 
                     auto plod = vsg::PagedLOD::create();
                     plod->bound = bound;
                     plod->children[0] = vsg::PagedLOD::Child{0.25, {}};  // external child visible when it's bound occupies more than 1/4 of the height of the window
                     plod->children[1] = vsg::PagedLOD::Child{0.0, tile}; // visible always
                     plod->filename = vsg::make_string(x, " ", y, " 0.tile");
-                    plod->options = options;
+                    plod->options = createSubtileOptions(*tile, options);
 
-                    group->addChild(plod);
+                    parent->addChild(cullBehindHorizon(plod, tileBound));
                 }
             }
+            else if (pageMissingTiles)
+            {
+                // placeholder that draws nothing until the pager has read the tile, see read_tile()
+                auto plod = vsg::PagedLOD::create();
+                plod->bound = computeTileBound(x, y, lod);
+                plod->children[0] = vsg::PagedLOD::Child{0.0, {}};
+                plod->children[1] = vsg::PagedLOD::Child{0.0, vsg::Group::create()};
+                plod->filename = vsg::make_string(x, " ", y, " 0.refine.tile");
+                plod->options = options;
+
+                parent->addChild(plod);
+            }
         }
     }
 
-    uint32_t maxLevel = 20;
-    uint32_t estimatedNumOfTilesBelow = 0;
-    uint32_t maxNumTilesBelow = 1024;
-
-    uint32_t level = 0;
-    for (uint32_t i = level; i < maxLevel; ++i)
+    // size the preallocation from the tiles that can actually be resident, using the root tiles as a guide to the memory used by each tile.
+    // With none of the root tiles resident yet the ResourceHints are left to the placeholders and the descriptor pools grow as tiles are paged in.
+    uint32_t numRootTiles = std::max(settings->noX * settings->noY, 1u);
+    // numPreallocatedTiles is read by tileCreated() on the loading threads so is assigned under the statsMutex
+    uint64_t bytesPerTile = 0;
+    uint32_t maxResidentTiles = 0;
     {
-        estimatedNumOfTilesBelow += std::pow(4, i - level);
+        std::scoped_lock<std::mutex> lock(statsMutex);
+        if (numResidentTiles > 0) bytesPerTile = residentTileBytes / numResidentTiles;
+        maxResidentTiles = numPreallocatedTiles = computeMaxResidentTiles(bytesPerTile);
     }
 
-    uint32_t tileMultiplier = std::min(estimatedNumOfTilesBelow, maxNumTilesBelow) + 1;
+    uint32_t tileMultiplier = (maxResidentTiles + numRootTiles - 1) / numRootTiles + 1;
+
+    vsg::debug("TileReader::read_root() bytesPerTile = ", bytesPerTile, ", numPreallocatedTiles = ", maxResidentTiles, ", tileMultiplier = ", tileMultiplier);
 
     // set up the ResourceHints required to make sure the VSG preallocates enough Vulkan resources for the paged database
     vsg::CollectResourceRequirements collectResourceRequirements;
@@ -243,23 +741,96 @@ vsg::ref_ptr<vsg::Object> TileReader::read_root(vsg::ref_ptr<const vsg::Options>
     return group;
 }
 
+vsg::ref_ptr<StartupBundle> TileReader::createStartupBundle(bool includeRootTiles, vsg::ref_ptr<const vsg::Options> options) const
+{
+    auto bundle = StartupBundle::create();
+    bundle->gpuTerrainDisplacement = gpuTerrainDisplacement;
+    bundle->textureArrays = textureArrays;
+
+    if (graphicsPipeline)
+    {
+        for (auto& stage : graphicsPipeline->stages)
+        {
+            if (stage->stage == VK_SHADER_STAGE_VERTEX_BIT) bundle->vertexShader = stage;
+            else if (stage->stage == VK_SHADER_STAGE_FRAGMENT_BIT) bundle->fragmentShader = stage;
+        }
+    }
+
+    // shaders read from source are otherwise only compiled to SPIR-V as the pipeline is compiled, so compile them now for the bundle to skip that at startup
+    vsg::ShaderStages sourceShaders;
+    for (auto& shader : {bundle->vertexShader, bundle->fragmentShader})
+    {
+        if (shader && shader->module && shader->module->code.empty()) sourceShaders.push_back(shader);
+    }
+
+    if (!sourceShaders.empty())
+    {
+        auto shaderCompiler = vsg::ShaderCompiler::create();
+        if (!shaderCompiler->compile(sourceShaders)) vsg::warn("TileReader::createStartupBundle() could not compile shaders, they will be compiled at startup.");
+    }
+
+    if (includeRootTiles)
+    {
+        uint32_t numTiles = settings->noX * settings->noY;
+        std::vector<vsg::ref_ptr<FetchTile>> imageFetches;
+        std::vector<vsg::ref_ptr<FetchTile>> terrainFetches;
+        for (uint32_t i = 0; i < numTiles; ++i)
+        {
+            vsg::dsphere bound(0.0, 0.0, 0.0, 0.0);
+            imageFetches.push_back(fetchTile(settings->imageLayer, i % settings->noX, i / settings->noX, 0, bound, false, options));
+            if (!settings->terrainLayer.empty()) terrainFetches.push_back(fetchTile(settings->terrainLayer, i % settings->noX, i / settings->noX, 0, bound, false, options));
+        }
+
+        for (uint32_t i = 0; i < numTiles; ++i)
+        {
+            auto image = imageFetches[i]->wait<vsg::Data>();
+            if (!image) vsg::warn("TileReader::createStartupBundle() could not fetch root tile ", i % settings->noX, " ", i / settings->noX, ", it will be paged in at startup.");
+
+            bundle->rootImages.push_back(image);
+            bundle->rootTerrains.push_back(terrainFetches.empty() ? vsg::ref_ptr<vsg::Data>() : terrainFetches[i]->wait<vsg::Data>());
+        }
+    }
+
+    return bundle;
+}
+
 vsg::ref_ptr<vsg::Object> TileReader::read_subtile(uint32_t x, uint32_t y, uint32_t lod, vsg::ref_ptr<const vsg::Options> options) const
 {
     // need to load subtile x y lod
 
+    if (incrementalRefinement && options)
+    {
+        if (auto parentTile = options->getObject<ParentTile>("ParentTile")) return read_placeholders(x, y, lod, *parentTile, options);
+    }
+
     vsg::time_point start_read = vsg::clock::now();
 
+    // texture array batches share state between the 4 subtiles so are cached as a whole, without the PagedLODs that the DatabasePager manages
+    bool cacheBatches = memoryCache && settings->memoryCacheSubgraphs && textureArrays;
+    if (cacheBatches)
+    {
+        if (auto cachedBatch = memoryCache->get("subgraphs", x, y, lod).cast<TextureArrayBatch>()) return createBatchGroup(*cachedBatch, x, y, lod, options);
+    }
+
     auto group = vsg::Group::create();
 
     struct TileID
     {
         uint32_t local_x;
         uint32_t local_y;
+        vsg::ref_ptr<FetchTile> imageFetch;
+        vsg::ref_ptr<FetchTile> terrainFetch;
+        vsg::ref_ptr<vsg::Node> cachedTile;
+        vsg::ref_ptr<vsg::Data> image;
+        vsg::ref_ptr<vsg::Data> terrain;
+        bool filled = false;
     };
 
-    vsg::Paths tiles;
-    std::map<vsg::Path, TileID> pathToTileID;
+    bool cacheSubgraphs = memoryCache && settings->memoryCacheSubgraphs && !textureArrays;
+
+    std::vector<TileID> tileIDs;
 
+    // issue the reads of all 4 subtiles before building any of them so the fetches run concurrently with mesh construction
     uint32_t subtile_x = x * 2;
     uint32_t subtile_y = y * 2;
     uint32_t local_lod = lod + 1;
@@ -269,91 +840,525 @@ vsg::ref_ptr<vsg::Object> TileReader::read_subtile(uint32_t x, uint32_t y, uint3
         {
             uint32_t local_x = subtile_x + dx;
             uint32_t local_y = subtile_y + dy;
-            auto tilePath = getTilePath(settings->imageLayer, local_x, local_y, local_lod);
-            tiles.push_back(tilePath);
-            pathToTileID[tilePath] = TileID{local_x, local_y};
-        }
-    }
 
-    auto pathObjects = vsg::read(tiles, options);
-
-    if (pathObjects.size() == 4)
-    {
-        for (auto& [tilePath, object] : pathObjects)
-        {
-            auto& tileID = pathToTileID[tilePath];
-            auto imageTile = object.cast<vsg::Data>();
-            if (imageTile)
+            // previously built subgraphs don't need fetching or building again
+            if (cacheSubgraphs)
             {
-                auto tile_extents = computeTileExtents(tileID.local_x, tileID.local_y, local_lod);
-                auto tile = createTile(tile_extents, imageTile);
-                if (tile)
+                if (auto cachedTile = memoryCache->get("subgraph", local_x, local_y, local_lod).cast<vsg::Node>())
                 {
-                    vsg::ComputeBounds computeBound;
-                    tile->accept(computeBound);
-                    auto& bb = computeBound.bounds;
-                    vsg::dsphere bound((bb.min.x + bb.max.x) * 0.5, (bb.min.y + bb.max.y) * 0.5, (bb.min.z + bb.max.z) * 0.5, vsg::length(bb.max - bb.min) * 0.5);
-
-                    if (local_lod < settings->maxLevel)
-                    {
-                        auto plod = vsg::PagedLOD::create();
-                        plod->bound = bound;
-                        plod->children[0] = vsg::PagedLOD::Child{settings->lodTransitionScreenHeightRatio, {}}; // external child visible when it's bound occupies more than 1/4 of the height of the window
-                        plod->children[1] = vsg::PagedLOD::Child{0.0, tile};                                    // visible always
-                        plod->filename = vsg::make_string(tileID.local_x, " ", tileID.local_y, " ", local_lod, ".tile");
-                        plod->options = options;
-
-                        vsg::debug("plod->filename ", plod->filename);
-
-                        group->addChild(plod);
-                    }
-                    else
-                    {
-                        auto cullGroup = vsg::CullGroup::create();
-                        cullGroup->bound = bound;
-                        cullGroup->addChild(tile);
-
-                        group->addChild(cullGroup);
-                    }
+                    tileIDs.push_back(TileID{local_x, local_y, {}, {}, cachedTile, {}, {}, false});
+                    continue;
                 }
             }
-        }
-    }
 
-    vsg::time_point end_read = vsg::clock::now();
+            // the terrain is fetched alongside the image so it adds no extra serial latency
+            TileID tileID{local_x, local_y, {}, {}, {}, {}, {}, false};
 
-    double time_to_read_tile = std::chrono::duration<float, std::chrono::milliseconds::period>(end_read - start_read).count();
+            auto bound = loadScheduler ? computeTileBound(local_x, local_y, local_lod) : vsg::dsphere();
 
-    {
-        std::scoped_lock<std::mutex> lock(statsMutex);
-        numTilesRead += 1;
-        totalTimeReadingTiles += time_to_read_tile;
-    }
+            tileID.imageFetch = fetchTile(settings->imageLayer, local_x, local_y, local_lod, bound, false, options);
 
-    if (group->children.size() != 4)
-    {
-        vsg::warn("Could not load all 4 subtiles, loaded only ", group->children.size(), " tiles.");
+            if (!settings->terrainLayer.empty())
+            {
+                tileID.terrainFetch = fetchTile(settings->terrainLayer, local_x, local_y, local_lod, bound, false, options);
+            }
 
-        return {};
+            tileIDs.push_back(tileID);
+        }
     }
 
-    return group;
-}
-
-void TileReader::init(vsg::ref_ptr<const vsg::Options> options)
-{
-    if (!descriptorSetLayout)
+    bool cancelled = false;
+    for (auto& tileID : tileIDs)
     {
-        vsg::DescriptorSetLayoutBindings descriptorBindings{
-            {0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr} // { binding, descriptorTpe, descriptorCount, stageFlags, pImmutableSamplers}
-        };
+        if (tileID.cachedTile) continue;
 
-        descriptorSetLayout = vsg::DescriptorSetLayout::create(descriptorBindings);
+        tileID.image = tileID.imageFetch->wait<vsg::Data>();
+        tileID.terrain = tileID.terrainFetch ? tileID.terrainFetch->wait<vsg::Data>() : vsg::ref_ptr<vsg::Data>();
+        if (tileID.imageFetch->cancelled || (tileID.terrainFetch && tileID.terrainFetch->cancelled)) cancelled = true;
     }
 
-    if (!pipelineLayout)
+    // rather than discard the subtiles that were fetched when one fails, stand in for the failed subtile with the matching quadrant of the parent tile,
+    // the parent is usually still in one of the caches. Cancelled subtiles are no longer needed so are left for the pager to request again.
+    bool filled = false;
+    if (settings->fillMissingSubtiles && !cancelled)
     {
-        vsg::PushConstantRanges pushConstantRanges{
+        vsg::ref_ptr<FetchTile> parentImageFetch;
+        vsg::ref_ptr<FetchTile> parentTerrainFetch;
+
+        auto fillQuadrant = [&](const vsg::Path& layer, vsg::ref_ptr<FetchTile>& parentFetch, const TileID& tileID) -> vsg::ref_ptr<vsg::Data> {
+            if (!parentFetch) parentFetch = fetchTile(layer, x, y, lod, vsg::dsphere(0.0, 0.0, 0.0, 0.0), false, options);
+
+            auto parentData = parentFetch->wait<vsg::Data>();
+            if (!parentData) return {};
+
+            // tile rows run north to south when originTopLeft, image rows run north to south when the image origin is TOP_LEFT
+            bool north = settings->originTopLeft == (tileID.local_y == subtile_y);
+            bool topLeft = parentData->getLayout().origin == vsg::TOP_LEFT;
+            return upsampleQuadrant(*parentData, tileID.local_x - subtile_x, (north == topLeft) ? 0 : 1, tileDataPool.get());
+        };
+
+        for (auto& tileID : tileIDs)
+        {
+            if (tileID.cachedTile) continue;
+
+            if (!tileID.image && (tileID.image = fillQuadrant(settings->imageLayer, parentImageFetch, tileID))) tileID.filled = true;
+            if (tileID.terrainFetch && !tileID.terrain && (tileID.terrain = fillQuadrant(settings->terrainLayer, parentTerrainFetch, tileID))) tileID.filled = true;
+
+            if (tileID.filled)
+            {
+                vsg::debug("Filled subtile ", tileID.local_x, " ", tileID.local_y, " ", local_lod, " from its parent tile.");
+                filled = true;
+            }
+        }
+    }
+
+    // a subtile whose terrain couldn't be fetched or filled is dropped like one without an image, rather than built flat and cached
+    for (auto& tileID : tileIDs)
+    {
+        if (tileID.terrainFetch && !tileID.terrain) tileID.image = {};
+    }
+
+    // when batching textures all 4 subtiles are needed up front so their images can be packed into shared texture arrays
+    auto batch = TextureArrayBatch::create();
+    size_t batchSize = 0;
+    if (textureArrays)
+    {
+        vsg::DataList images, terrains;
+        for (auto& tileID : tileIDs)
+        {
+            images.push_back(tileID.image);
+            terrains.push_back(tileID.terrain);
+            if (images.back())
+            {
+                auto& grid = selectGrid(computeTileExtents(tileID.local_x, tileID.local_y, local_lod));
+                batchSize += images.back()->dataSize() + grid.numRows * grid.numCols * sizeof(vsg::vec3);
+            }
+        }
+
+        createTextureArrays(images, terrains, batch->layers);
+        batch->tiles.resize(tileIDs.size());
+    }
+
+    uint32_t numTiles = 0;
+    uint64_t uploadBytes = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> prefetchTiles;
+    for (size_t i = 0; i < tileIDs.size(); ++i)
+    {
+        auto& tileID = tileIDs[i];
+
+        int32_t textureLayer = -1;
+        if (textureArrays)
+        {
+            if (!batch->layers[i].stateGroup) continue;
+            textureLayer = batch->layers[i].layer;
+        }
+
+        auto tile = tileID.cachedTile;
+        if (!tile)
+        {
+            if (tileID.image)
+            {
+                auto tile_extents = computeTileExtents(tileID.local_x, tileID.local_y, local_lod);
+                tile = createTile(tile_extents, tileID.image, tileID.terrain, textureLayer);
+                if (tile && uploadBudget)
+                {
+                    if (auto residentTile = tile->getObject<ResidentTile>("ResidentTile")) uploadBytes += residentTile->size;
+                }
+
+                // filled tiles aren't cached so the real tile is fetched the next time the subtiles are read
+                if (tile && cacheSubgraphs && !tileID.filled)
+                {
+                    auto& grid = selectGrid(tile_extents);
+                    memoryCache->insert("subgraph", tileID.local_x, tileID.local_y, local_lod, tile, tileID.image->dataSize() + grid.numRows * grid.numCols * sizeof(vsg::vec3));
+                }
+            }
+        }
+
+        if (tile)
+        {
+            if (textureArrays)
+                batch->tiles[i] = tile;
+            else
+                group->addChild(createTileLOD(tile, tileID.local_x, tileID.local_y, local_lod, options));
+
+            if (local_lod < settings->maxLevel && prefetchNeeded(*tile, tileID.local_x, tileID.local_y, local_lod)) prefetchTiles.emplace_back(tileID.local_x, tileID.local_y);
+
+            ++numTiles;
+        }
+    }
+
+    vsg::time_point end_read = vsg::clock::now();
+
+    loadStats->add(TileLoadStats::READ_SUBTILE, start_read, end_read);
+
+    double time_to_read_tile = std::chrono::duration<float, std::chrono::milliseconds::period>(end_read - start_read).count();
+
+    {
+        std::scoped_lock<std::mutex> lock(statsMutex);
+        numTilesRead += 1;
+        totalTimeReadingTiles += time_to_read_tile;
+    }
+
+    if (numTiles != 4)
+    {
+        if (cancelled)
+            vsg::debug("Subtiles of ", x, " ", y, " ", lod, " cancelled as no longer in view.");
+        else
+            vsg::warn("Could not load all 4 subtiles, loaded only ", numTiles, " tiles.");
+
+        // the pager requests the subtiles again once the failed one's backoff allows, so hold the fetched siblings rather than fetch them again with it
+        if (heldSubtiles && !cancelled)
+        {
+            auto backingOff = [](const vsg::ref_ptr<FetchTile>& fetch) { return fetch && fetch->backingOff; };
+            auto hold = [&](const vsg::ref_ptr<FetchTile>& fetch) {
+                if (auto data = fetch ? fetch->object.cast<vsg::Data>() : vsg::ref_ptr<vsg::Data>()) heldSubtiles->insert(fetch->layer.string(), fetch->x, fetch->y, fetch->level, data, data->dataSize());
+            };
+
+            if (std::any_of(tileIDs.begin(), tileIDs.end(), [&](const TileID& tileID) { return backingOff(tileID.imageFetch) || backingOff(tileID.terrainFetch); }))
+            {
+                for (auto& tileID : tileIDs)
+                {
+                    hold(tileID.imageFetch);
+                    hold(tileID.terrainFetch);
+                }
+            }
+        }
+
+        return {};
+    }
+
+    // prefetched tiles are only kept by the caches so there is no point fetching them without one
+    if (!prefetchTiles.empty() && (memoryCache || tileCache)) prefetchSubtiles(prefetchTiles, local_lod, options);
+
+    if (textureArrays)
+    {
+        group = createBatchGroup(*batch, x, y, lod, options);
+        if (cacheBatches && !filled) memoryCache->insert("subgraphs", x, y, lod, batch, batchSize);
+    }
+
+    // hold the tiles back until the frame's upload budget has room for them, cached tiles were compiled when first merged so aren't counted
+    if (uploadBudget && uploadBytes > 0)
+    {
+        auto start_wait = vsg::clock::now();
+        uploadBudget->acquire(uploadBytes);
+        loadStats->add(TileLoadStats::UPLOAD_WAIT, start_wait, vsg::clock::now());
+    }
+
+    return group;
+}
+
+vsg::ref_ptr<vsg::Group> TileReader::createBatchGroup(const TextureArrayBatch& batch, uint32_t x, uint32_t y, uint32_t lod, vsg::ref_ptr<const vsg::Options> options) const
+{
+    auto group = vsg::Group::create();
+
+    // the batch's StateGroups are only templates of the texture array bindings, fresh StateGroups hold the PagedLODs so the cached batch never holds a paged subgraph
+    std::map<const vsg::StateGroup*, vsg::ref_ptr<vsg::StateGroup>> stateGroups;
+    for (size_t i = 0; i < batch.tiles.size(); ++i)
+    {
+        auto& layer = batch.layers[i];
+        if (!batch.tiles[i] || !layer.stateGroup) continue;
+
+        auto& stateGroup = stateGroups[layer.stateGroup.get()];
+        if (!stateGroup)
+        {
+            stateGroup = vsg::StateGroup::create();
+            stateGroup->stateCommands = layer.stateGroup->stateCommands;
+            group->addChild(stateGroup);
+        }
+
+        // the subtiles are read, and batched, by row then column
+        uint32_t local_x = x * 2 + static_cast<uint32_t>(i % 2);
+        uint32_t local_y = y * 2 + static_cast<uint32_t>(i / 2);
+        stateGroup->addChild(createTileLOD(batch.tiles[i], local_x, local_y, lod + 1, options));
+    }
+
+    return group;
+}
+
+vsg::ref_ptr<vsg::Object> TileReader::read_placeholders(uint32_t x, uint32_t y, uint32_t lod, const ParentTile& parentTile, vsg::ref_ptr<const vsg::Options> options) const
+{
+    vsg::time_point start_read = vsg::clock::now();
+
+    auto group = vsg::Group::create();
+
+    // the placeholders are built from the parent's texture binding and terrain alone so can be returned without waiting on any fetches
+    uint32_t subtile_x = x * 2;
+    uint32_t subtile_y = y * 2;
+    uint32_t local_lod = lod + 1;
+    for (uint32_t dy = 0; dy < 2; ++dy)
+    {
+        for (uint32_t dx = 0; dx < 2; ++dx)
+        {
+            uint32_t local_x = subtile_x + dx;
+            uint32_t local_y = subtile_y + dy;
+            auto tile_extents = computeTileExtents(local_x, local_y, local_lod);
+
+            // tile rows run north to south when originTopLeft, image rows run north to south when the image origin is TOP_LEFT
+            vsg::ref_ptr<vsg::Data> terrain;
+            if (parentTile.terrain)
+            {
+                bool north = settings->originTopLeft == (dy == 0);
+                bool topLeft = parentTile.terrain->getLayout().origin == vsg::TOP_LEFT;
+                terrain = upsampleQuadrant(*parentTile.terrain, dx, (north == topLeft) ? 0 : 1, tileDataPool.get());
+            }
+
+            auto placeholder = createECEFTile(tile_extents, {}, terrain, -1, &parentTile);
+            if (!placeholder) return {};
+
+            auto tileBound = placeholder->getObject<TileBound>("TileBound");
+
+            // the subtile is requested as soon as the placeholder is visible, unless it would be cancelled as too small, and replaces the placeholder once loaded
+            auto plod = vsg::PagedLOD::create();
+            plod->bound = tileBound ? tileBound->sphere : computeTileBound(local_x, local_y, local_lod);
+            plod->children[0] = vsg::PagedLOD::Child{settings->cancelScreenHeightRatio, {}};
+            plod->children[1] = vsg::PagedLOD::Child{0.0, placeholder};
+            plod->filename = vsg::make_string(local_x, " ", local_y, " ", local_lod, ".refine.tile");
+            plod->options = options;
+
+            group->addChild(cullBehindHorizon(plod, tileBound));
+        }
+    }
+
+    loadStats->add(TileLoadStats::READ_SUBTILE, start_read, vsg::clock::now());
+
+    return group;
+}
+
+vsg::ref_ptr<vsg::Object> TileReader::read_tile(uint32_t x, uint32_t y, uint32_t lod, vsg::ref_ptr<const vsg::Options> options) const
+{
+    vsg::time_point start_read = vsg::clock::now();
+
+    bool cacheSubgraphs = memoryCache && settings->memoryCacheSubgraphs;
+
+    auto tile = cacheSubgraphs ? memoryCache->get("subgraph", x, y, lod).cast<vsg::Node>() : vsg::ref_ptr<vsg::Node>();
+    uint64_t uploadBytes = 0;
+    if (!tile)
+    {
+        auto bound = loadScheduler ? computeTileBound(x, y, lod) : vsg::dsphere();
+
+        auto imageFetch = fetchTile(settings->imageLayer, x, y, lod, bound, false, options);
+        auto terrainFetch = settings->terrainLayer.empty() ? vsg::ref_ptr<FetchTile>() : fetchTile(settings->terrainLayer, x, y, lod, bound, false, options);
+
+        auto image = imageFetch->wait<vsg::Data>();
+        auto terrain = terrainFetch ? terrainFetch->wait<vsg::Data>() : vsg::ref_ptr<vsg::Data>();
+
+        // the placeholder stays in place of tiles that couldn't be fetched, or were cancelled, until the pager requests them again
+        if (!image || (terrainFetch && !terrain))
+        {
+            if (!imageFetch->cancelled && !(terrainFetch && terrainFetch->cancelled)) vsg::warn("Could not load tile ", x, " ", y, " ", lod, ", keeping its placeholder.");
+            return {};
+        }
+
+        auto tile_extents = computeTileExtents(x, y, lod);
+        tile = createTile(tile_extents, image, terrain);
+        if (!tile) return {};
+
+        if (auto residentTile = tile->getObject<ResidentTile>("ResidentTile")) uploadBytes = residentTile->size;
+
+        if (cacheSubgraphs)
+        {
+            auto& grid = selectGrid(tile_extents);
+            memoryCache->insert("subgraph", x, y, lod, tile, image->dataSize() + grid.numRows * grid.numCols * sizeof(vsg::vec3));
+        }
+    }
+
+    auto node = createTileLOD(tile, x, y, lod, options);
+
+    vsg::time_point end_read = vsg::clock::now();
+
+    loadStats->add(TileLoadStats::READ_SUBTILE, start_read, end_read);
+
+    {
+        std::scoped_lock<std::mutex> lock(statsMutex);
+        numTilesRead += 1;
+        totalTimeReadingTiles += std::chrono::duration<float, std::chrono::milliseconds::period>(end_read - start_read).count();
+    }
+
+    // prefetched tiles are only kept by the caches so there is no point fetching them without one
+    if (lod < settings->maxLevel && (memoryCache || tileCache) && prefetchNeeded(*tile, x, y, lod)) prefetchSubtiles({{x, y}}, lod, options);
+
+    if (uploadBudget && uploadBytes > 0)
+    {
+        auto start_wait = vsg::clock::now();
+        uploadBudget->acquire(uploadBytes);
+        loadStats->add(TileLoadStats::UPLOAD_WAIT, start_wait, vsg::clock::now());
+    }
+
+    return node;
+}
+
+vsg::ref_ptr<vsg::Node> TileReader::createTileLOD(vsg::ref_ptr<vsg::Node> tile, uint32_t x, uint32_t y, uint32_t lod, vsg::ref_ptr<const vsg::Options> options) const
+{
+    // the bound is computed with the tile's mesh, and cached along with the tile's subgraph
+    auto tileBound = tile->getObject<TileBound>("TileBound");
+    vsg::dsphere bound = tileBound ? tileBound->sphere : computeTileBound(x, y, lod);
+
+    if (lod < settings->maxLevel)
+    {
+        auto plod = vsg::PagedLOD::create();
+        plod->bound = bound;
+        plod->children[0] = vsg::PagedLOD::Child{settings->lodTransitionScreenHeightRatio, {}}; // external child visible when it's bound occupies more than 1/4 of the height of the window
+        plod->children[1] = vsg::PagedLOD::Child{0.0, tile};                                    // visible always
+        plod->filename = vsg::make_string(x, " ", y, " ", lod, ".tile");
+        plod->options = createSubtileOptions(*tile, options);
+
+        vsg::debug("plod->filename ", plod->filename);
+
+        return cullBehindHorizon(plod, tileBound);
+    }
+
+    auto cullGroup = vsg::CullGroup::create();
+    cullGroup->bound = bound;
+    cullGroup->addChild(tile);
+
+    return cullBehindHorizon(cullGroup, tileBound);
+}
+
+vsg::ref_ptr<const vsg::Options> TileReader::createSubtileOptions(vsg::Node& tile, vsg::ref_ptr<const vsg::Options> options) const
+{
+    auto parentTile = incrementalRefinement ? tile.getObject<ParentTile>("ParentTile") : nullptr;
+    if (!parentTile || !options) return options;
+
+    auto subtileOptions = vsg::Options::create(*options);
+    subtileOptions->setObject("ParentTile", vsg::ref_ptr<ParentTile>(parentTile));
+    return subtileOptions;
+}
+
+bool TileReader::prefetchNeeded(const vsg::Node& tile, uint32_t x, uint32_t y, uint32_t lod) const
+{
+    if (!loadScheduler || loadScheduler->prefetchTime <= 0.0) return false;
+
+    // subtiles the pager doesn't need yet but will once the camera has moved on for prefetchTime
+    auto tileBound = tile.getObject<TileBound>("TileBound");
+    vsg::dsphere bound = tileBound ? tileBound->sphere : computeTileBound(x, y, lod);
+    return loadScheduler->screenHeightRatio(bound) < settings->lodTransitionScreenHeightRatio &&
+           loadScheduler->predictedScreenHeightRatio(bound) >= settings->lodTransitionScreenHeightRatio;
+}
+
+void TileReader::prefetchSubtiles(const std::vector<std::pair<uint32_t, uint32_t>>& tiles, uint32_t lod, vsg::ref_ptr<const vsg::Options> options) const
+{
+    // results are only kept by the caches, the loadScheduler holds the fetches until they've run or been cancelled
+    uint32_t local_lod = lod + 1;
+    for (auto& [x, y] : tiles)
+    {
+        for (uint32_t dy = 0; dy < 2; ++dy)
+        {
+            for (uint32_t dx = 0; dx < 2; ++dx)
+            {
+                uint32_t local_x = x * 2 + dx;
+                uint32_t local_y = y * 2 + dy;
+                auto bound = computeTileBound(local_x, local_y, local_lod);
+
+                fetchTile(settings->imageLayer, local_x, local_y, local_lod, bound, true, options);
+
+                if (!settings->terrainLayer.empty())
+                {
+                    fetchTile(settings->terrainLayer, local_x, local_y, local_lod, bound, true, options);
+                }
+            }
+        }
+    }
+}
+
+void TileReader::init(vsg::ref_ptr<const vsg::Options> options)
+{
+    if (settings->prioritizedLoading && settings->numFetchThreads > 0)
+    {
+        if (!loadScheduler) loadScheduler = TileLoadScheduler::create(settings->numFetchThreads, settings->prefetchTime, settings->cancelScreenHeightRatio);
+    }
+    else if (!fetchThreads && settings->numFetchThreads > 0)
+    {
+        fetchThreads = vsg::OperationThreads::create(settings->numFetchThreads);
+    }
+
+    if (!tileCache && !settings->tileCachePath.empty())
+    {
+        tileCache = TileCache::create(settings->tileCachePath, settings->tileCacheMaxSize, settings->tileCacheExpiryTime);
+    }
+
+    if (!memoryCache && settings->memoryCacheMaxSize > 0)
+    {
+        memoryCache = MemoryTileCache::create(settings->memoryCacheMaxSize);
+    }
+
+    if (!loadStats)
+    {
+        loadStats = TileLoadStats::create(settings->loadStatsTraceEvents);
+    }
+
+    if (!uploadBudget && settings->uploadBytesPerFrame > 0)
+    {
+        uploadBudget = TileUploadBudget::create(settings->uploadBytesPerFrame);
+    }
+
+    if (!imageRasterLayer && RasterTileLayer::isRasterLayer(settings->imageLayer))
+    {
+        imageRasterLayer = RasterTileLayer::create(RasterTileLayer::rasterFilename(settings->imageLayer), settings, settings->rasterTileSize);
+    }
+
+    if (!terrainRasterLayer && RasterTileLayer::isRasterLayer(settings->terrainLayer))
+    {
+        terrainRasterLayer = RasterTileLayer::create(RasterTileLayer::rasterFilename(settings->terrainLayer), settings, settings->rasterTileSize);
+    }
+
+    if (!fetchBackoff && (settings->fetchRetries > 0 || settings->fetchRetryDelay > 0.0))
+    {
+        fetchBackoff = FetchBackoff::create(settings->fetchRetryDelay, settings->fetchRetryMaxDelay, settings->fetchRetries);
+    }
+
+    if (!heldSubtiles && fetchBackoff)
+    {
+        heldSubtiles = MemoryTileCache::create(heldSubtilesMaxSize);
+    }
+
+    if (!tileDataPool && settings->tileDataPoolMaxSize > 0)
+    {
+        tileDataPool = TileDataPool::create(settings->tileDataPoolMaxSize);
+    }
+
+    if (settings->textureCompression == "BC1")
+        textureCompressionFormat = VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    else if (settings->textureCompression == "BC3")
+        textureCompressionFormat = VK_FORMAT_BC3_UNORM_BLOCK;
+    else if (!settings->textureCompression.empty())
+        vsg::warn("TileReader::init() unsupported textureCompression \"", settings->textureCompression, "\", tiles will not be compressed.");
+
+    // compressed tiles carry their own mipmap chains which can't be packed into texture arrays
+    textureArrays = settings->textureArrays;
+    if (textureArrays && textureCompressionFormat != VK_FORMAT_UNDEFINED)
+    {
+        vsg::warn("TileReader::init() textureArrays not supported with textureCompression, disabling textureArrays.");
+        textureArrays = false;
+    }
+
+    // the placeholders are drawn with their parent's own descriptor set, which tiles packed into texture arrays don't have
+    incrementalRefinement = settings->incrementalRefinement;
+    if (incrementalRefinement && textureArrays)
+    {
+        vsg::warn("TileReader::init() incrementalRefinement not supported with textureArrays, disabling incrementalRefinement.");
+        incrementalRefinement = false;
+    }
+
+    // GPU displacement only makes sense when there is terrain to displace by
+    gpuTerrainDisplacement = settings->gpuTerrainDisplacement && !settings->terrainLayer.empty();
+
+    if (!descriptorSetLayout)
+    {
+        vsg::DescriptorSetLayoutBindings descriptorBindings{
+            {0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr} // { binding, descriptorTpe, descriptorCount, stageFlags, pImmutableSamplers}
+        };
+
+        if (gpuTerrainDisplacement)
+        {
+            descriptorBindings.push_back({1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr}); // height texture
+        }
+
+        descriptorSetLayout = vsg::DescriptorSetLayout::create(descriptorBindings);
+    }
+
+    if (!pipelineLayout)
+    {
+        vsg::PushConstantRanges pushConstantRanges{
             {VK_SHADER_STAGE_VERTEX_BIT, 0, 128} // projection view, and model matrices, actual push constant calls autoaatically provided by the VSG's DispatchTraversal
         };
 
@@ -363,7 +1368,9 @@ void TileReader::init(vsg::ref_ptr<const vsg::Options> options)
     if (!sampler)
     {
         sampler = vsg::Sampler::create();
+        // cap the levels generated on the GPU, for tiles without mipmaps, at those of a rasterTileSize tile
         sampler->maxLod = settings->mipmapLevelsHint;
+        if (settings->minMipmapSize > 1) sampler->maxLod = static_cast<float>(computeNumMipmaps(settings->rasterTileSize, settings->rasterTileSize, settings->mipmapLevelsHint, settings->minMipmapSize));
         sampler->addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
         sampler->addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
         sampler->addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
@@ -371,13 +1378,82 @@ void TileReader::init(vsg::ref_ptr<const vsg::Options> options)
         sampler->maxAnisotropy = 16.0f;
     }
 
+    if (gpuTerrainDisplacement && !heightSampler)
+    {
+        // heights are fetched and interpolated explicitly in the vertex shader so no filtering or mipmapping is required
+        heightSampler = vsg::Sampler::create();
+        heightSampler->minFilter = VK_FILTER_NEAREST;
+        heightSampler->magFilter = VK_FILTER_NEAREST;
+        heightSampler->mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        heightSampler->maxLod = 0.0f;
+        heightSampler->addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        heightSampler->addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        heightSampler->addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    }
+
+    if (gpuTerrainDisplacement && !flatHeightTexture)
+    {
+        auto flatHeights = vsg::floatArray2D::create(2, 2, vsg::Data::Layout{VK_FORMAT_R32_SFLOAT});
+        for (auto& h : *flatHeights) h = 0.0f;
+
+        flatHeightTexture = vsg::DescriptorImage::create(heightSampler, flatHeights, 1, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+    }
+
     if (!graphicsPipeline)
     {
-        auto vertexShader = vsg::read_cast<vsg::ShaderStage>("shaders/simple_tile.vert", options);
-        if (!vertexShader) vertexShader = simple_tile_vert(); // fallback to shaders/simple_tile_vert.cppp
+        // the startupBundle's compiled shaders avoid reading and compiling the shader sources, as long as they were created for the same pipeline
+        vsg::ref_ptr<vsg::ShaderStage> vertexShader;
+        vsg::ref_ptr<vsg::ShaderStage> fragmentShader;
+        if (startupBundle)
+        {
+            if (startupBundle->gpuTerrainDisplacement == gpuTerrainDisplacement && startupBundle->textureArrays == textureArrays)
+            {
+                vertexShader = startupBundle->vertexShader;
+                fragmentShader = startupBundle->fragmentShader;
+            }
+            else
+            {
+                vsg::warn("TileReader::init() startupBundle shaders don't match the gpuTerrainDisplacement and textureArrays settings, reading shaders instead.");
+            }
+        }
+
+        if (!vertexShader)
+        {
+            if (gpuTerrainDisplacement && textureArrays)
+            {
+                vertexShader = vsg::read_cast<vsg::ShaderStage>("shaders/simple_tile_displace_array.vert", options);
+                if (!vertexShader) vertexShader = simple_tile_displace_array_vert(); // fallback to shaders/simple_tile_displace_array_vert.cpp
+            }
+            else if (gpuTerrainDisplacement)
+            {
+                vertexShader = vsg::read_cast<vsg::ShaderStage>("shaders/simple_tile_displace.vert", options);
+                if (!vertexShader) vertexShader = simple_tile_displace_vert(); // fallback to shaders/simple_tile_displace_vert.cpp
+            }
+            else if (textureArrays)
+            {
+                vertexShader = vsg::read_cast<vsg::ShaderStage>("shaders/simple_tile_array.vert", options);
+                if (!vertexShader) vertexShader = simple_tile_array_vert(); // fallback to shaders/simple_tile_array_vert.cpp
+            }
+            else
+            {
+                vertexShader = vsg::read_cast<vsg::ShaderStage>("shaders/simple_tile.vert", options);
+                if (!vertexShader) vertexShader = simple_tile_vert(); // fallback to shaders/simple_tile_vert.cppp
+            }
+        }
 
-        auto fragmentShader = vsg::read_cast<vsg::ShaderStage>("shaders/simple_tile.frag", options);
-        if (!fragmentShader) fragmentShader = simple_tile_frag(); // fallback to shaders/simple_tile_frag.cppp
+        if (!fragmentShader)
+        {
+            if (textureArrays)
+            {
+                fragmentShader = vsg::read_cast<vsg::ShaderStage>("shaders/simple_tile_array.frag", options);
+                if (!fragmentShader) fragmentShader = simple_tile_array_frag(); // fallback to shaders/simple_tile_array_frag.cpp
+            }
+            else
+            {
+                fragmentShader = vsg::read_cast<vsg::ShaderStage>("shaders/simple_tile.frag", options);
+                if (!fragmentShader) fragmentShader = simple_tile_frag(); // fallback to shaders/simple_tile_frag.cppp
+            }
+        }
 
         if (!vertexShader || !fragmentShader)
         {
@@ -386,16 +1462,28 @@ void TileReader::init(vsg::ref_ptr<const vsg::Options> options)
 
         vsg::VertexInputState::Bindings vertexBindingsDescriptions{
             VkVertexInputBindingDescription{0, sizeof(vsg::vec3), VK_VERTEX_INPUT_RATE_VERTEX}, // vertex data
-            VkVertexInputBindingDescription{1, sizeof(vsg::vec3), VK_VERTEX_INPUT_RATE_VERTEX}, // colour data
-            VkVertexInputBindingDescription{2, sizeof(vsg::vec2), VK_VERTEX_INPUT_RATE_VERTEX}  // tex coord data
+            VkVertexInputBindingDescription{1, sizeof(vsg::vec2), VK_VERTEX_INPUT_RATE_VERTEX}  // tex coord data
         };
 
         vsg::VertexInputState::Attributes vertexAttributeDescriptions{
             VkVertexInputAttributeDescription{0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0}, // vertex data
-            VkVertexInputAttributeDescription{1, 1, VK_FORMAT_R32G32B32_SFLOAT, 0}, // colour data
-            VkVertexInputAttributeDescription{2, 2, VK_FORMAT_R32G32_SFLOAT, 0},    // tex coord data
+            VkVertexInputAttributeDescription{1, 1, VK_FORMAT_R32G32_SFLOAT, 0},    // tex coord data
         };
 
+        if (gpuTerrainDisplacement)
+        {
+            vertexBindingsDescriptions.push_back(VkVertexInputBindingDescription{2, sizeof(vsg::vec3), VK_VERTEX_INPUT_RATE_VERTEX}); // normal data
+            vertexAttributeDescriptions.push_back(VkVertexInputAttributeDescription{2, 2, VK_FORMAT_R32G32B32_SFLOAT, 0});          // normal data
+            vertexBindingsDescriptions.push_back(VkVertexInputBindingDescription{3, sizeof(vsg::vec2), VK_VERTEX_INPUT_RATE_VERTEX}); // edge offset data
+            vertexAttributeDescriptions.push_back(VkVertexInputAttributeDescription{3, 3, VK_FORMAT_R32G32_SFLOAT, 0});             // edge offset data
+        }
+
+        if (textureArrays)
+        {
+            vertexBindingsDescriptions.push_back(VkVertexInputBindingDescription{4, sizeof(uint32_t), VK_VERTEX_INPUT_RATE_INSTANCE}); // texture array layer
+            vertexAttributeDescriptions.push_back(VkVertexInputAttributeDescription{4, 4, VK_FORMAT_R32_UINT, 0});                    // texture array layer
+        }
+
         vsg::GraphicsPipelineStates pipelineStates{
             vsg::VertexInputState::create(vertexBindingsDescriptions, vertexAttributeDescriptions),
             vsg::InputAssemblyState::create(),
@@ -406,6 +1494,475 @@ void TileReader::init(vsg::ref_ptr<const vsg::Options> options)
 
         graphicsPipeline = vsg::GraphicsPipeline::create(pipelineLayout, vsg::ShaderStages{vertexShader, fragmentShader}, pipelineStates);
     }
+
+    if (tileGrids.empty())
+    {
+        // the grids are only built here so selectGrid() can be called from the loading threads without locking
+        std::vector<uint32_t> gridSegments;
+        if (settings->adaptiveGrid)
+        {
+            for (uint32_t segments = computeGridSegments(0.0); segments <= computeGridSegments(360.0); segments *= 2) gridSegments.push_back(segments);
+        }
+        else
+        {
+            gridSegments.push_back(computeGridSegments(0.0));
+        }
+
+        for (auto segments : gridSegments)
+        {
+            auto& grid = tileGrids[segments];
+            grid.numRows = segments + 1;
+            grid.numCols = segments + 1;
+
+            uint32_t numRows = grid.numRows;
+            uint32_t numCols = grid.numCols;
+            uint32_t numGridVertices = numRows * numCols;
+
+            // anticlockwise around the edge from the bottom left corner
+            if (settings->adaptiveGrid)
+            {
+                for (uint32_t c = 0; c < numCols - 1; ++c) grid.perimeter.push_back(c);
+                for (uint32_t r = 0; r < numRows - 1; ++r) grid.perimeter.push_back(numCols - 1 + r * numCols);
+                for (uint32_t c = numCols - 1; c > 0; --c) grid.perimeter.push_back(c + (numRows - 1) * numCols);
+                for (uint32_t r = numRows - 1; r > 0; --r) grid.perimeter.push_back(r * numCols);
+            }
+
+            // texcoords only depend on the grid dimensions and the origin of the image, so set up both variants once and share them between all tiles
+            uint32_t numVertices = grid.numVertices();
+            float sCoordScale = 1.0f / float(numCols - 1);
+            float tCoordScale = 1.0f / float(numRows - 1);
+
+            auto texcoordsTopLeft = vsg::vec2Array::create(numVertices);
+            auto texcoordsBottomLeft = vsg::vec2Array::create(numVertices);
+            for (uint32_t r = 0; r < numRows; ++r)
+            {
+                for (uint32_t c = 0; c < numCols; ++c)
+                {
+                    uint32_t vi = c + r * numCols;
+                    texcoordsTopLeft->set(vi, vsg::vec2(float(c) * sCoordScale, 1.0f - float(r) * tCoordScale));
+                    texcoordsBottomLeft->set(vi, vsg::vec2(float(c) * sCoordScale, float(r) * tCoordScale));
+                }
+            }
+            for (uint32_t i = 0; i < grid.perimeter.size(); ++i)
+            {
+                texcoordsTopLeft->set(numGridVertices + i, texcoordsTopLeft->at(grid.perimeter[i]));
+                texcoordsBottomLeft->set(numGridVertices + i, texcoordsBottomLeft->at(grid.perimeter[i]));
+            }
+
+            if (gpuTerrainDisplacement)
+            {
+                grid.edgeOffsets = vsg::vec2Array::create(numVertices);
+                auto noEdgeOffsets = vsg::vec2Array::create(numVertices);
+
+                uint32_t topRow = (numRows - 1) * numCols;
+                for (uint32_t c = 1; c < numCols - 1; c += 2)
+                {
+                    grid.edgeOffsets->set(c, vsg::vec2(sCoordScale, 0.0f));
+                    grid.edgeOffsets->set(topRow + c, vsg::vec2(sCoordScale, 0.0f));
+                }
+                for (uint32_t r = 1; r < numRows - 1; r += 2)
+                {
+                    grid.edgeOffsets->set(r * numCols, vsg::vec2(0.0f, tCoordScale));
+                    grid.edgeOffsets->set(r * numCols + numCols - 1, vsg::vec2(0.0f, tCoordScale));
+                }
+
+                // the skirts hang from the matched edge vertices so share their offsets
+                for (uint32_t i = 0; i < grid.perimeter.size(); ++i) grid.edgeOffsets->set(numGridVertices + i, grid.edgeOffsets->at(grid.perimeter[i]));
+
+                grid.bindEdgeOffsets = vsg::BindVertexBuffers::create(3, vsg::DataList{grid.edgeOffsets});
+                grid.bindNoEdgeOffsets = vsg::BindVertexBuffers::create(3, vsg::DataList{noEdgeOffsets});
+            }
+
+            grid.bindTexCoordsTopLeft = vsg::BindVertexBuffers::create(1, vsg::DataList{texcoordsTopLeft});
+            grid.bindTexCoordsBottomLeft = vsg::BindVertexBuffers::create(1, vsg::DataList{texcoordsBottomLeft});
+
+            // the skirt quads are drawn from both sides so they close the gap whichever side of the edge the coarser neighbour is
+            uint32_t numPerimeter = static_cast<uint32_t>(grid.perimeter.size());
+            uint32_t numTriangles = (numRows - 1) * (numCols - 1) * 2 + numPerimeter * 4;
+
+            auto indices = vsg::ushortArray::create(numTriangles * 3);
+            auto itr = indices->begin();
+            for (uint32_t r = 0; r < numRows - 1; ++r)
+            {
+                for (uint32_t c = 0; c < numCols - 1; ++c)
+                {
+                    uint32_t vi = c + r * numCols;
+                    (*itr++) = vi;
+                    (*itr++) = vi + 1;
+                    (*itr++) = vi + numCols;
+                    (*itr++) = vi + numCols;
+                    (*itr++) = vi + 1;
+                    (*itr++) = vi + numCols + 1;
+                }
+            }
+            for (uint32_t i = 0; i < numPerimeter; ++i)
+            {
+                uint32_t next = (i + 1) % numPerimeter;
+                uint32_t top0 = grid.perimeter[i], top1 = grid.perimeter[next];
+                uint32_t bottom0 = numGridVertices + i, bottom1 = numGridVertices + next;
+                for (auto vi : {top0, bottom0, top1, top1, bottom0, bottom1, top0, top1, bottom0, top1, bottom1, bottom0}) (*itr++) = vi;
+            }
+
+            grid.bindIndexBuffer = vsg::BindIndexBuffer::create(indices);
+            grid.drawIndexed = vsg::DrawIndexed::create(indices->size(), 1, 0, 0, 0);
+        }
+    }
+}
+
+namespace
+{
+    // bilinear sample of a single channel heightfield at each vertex of a numRows x numCols grid, the heightfield corners are aligned with the grid corners so neighbouring tiles that share edge samples match up
+    template<typename T>
+    bool sampleHeightField(const vsg::Data& data, uint32_t numRows, uint32_t numCols, std::vector<float>& heights)
+    {
+        auto array = dynamic_cast<const vsg::Array2D<T>*>(&data);
+        if (!array || array->width() < 2 || array->height() < 2) return false;
+
+        uint32_t width = array->width();
+        uint32_t height = array->height();
+        bool topLeft = data.getLayout().origin == vsg::TOP_LEFT;
+
+        heights.resize(numRows * numCols);
+        for (uint32_t r = 0; r < numRows; ++r)
+        {
+            // grid rows run south to north
+            double t = double(r) / double(numRows - 1);
+            double py = (topLeft ? (1.0 - t) : t) * double(height - 1);
+            uint32_t j = std::min(static_cast<uint32_t>(py), height - 2);
+            double ry = py - double(j);
+
+            for (uint32_t c = 0; c < numCols; ++c)
+            {
+                double px = double(c) / double(numCols - 1) * double(width - 1);
+                uint32_t i = std::min(static_cast<uint32_t>(px), width - 2);
+                double rx = px - double(i);
+
+                double h00 = static_cast<double>(array->at(i, j));
+                double h10 = static_cast<double>(array->at(i + 1, j));
+                double h01 = static_cast<double>(array->at(i, j + 1));
+                double h11 = static_cast<double>(array->at(i + 1, j + 1));
+
+                heights[c + r * numCols] = static_cast<float>((h00 * (1.0 - rx) + h10 * rx) * (1.0 - ry) + (h01 * (1.0 - rx) + h11 * rx) * ry);
+            }
+        }
+        return true;
+    }
+
+    // copy a single channel heightfield into a float array, flipping the rows when the heightfield origin differs from the requested origin
+    template<typename T>
+    vsg::ref_ptr<vsg::Data> convertHeightField(const vsg::Data& data, vsg::Origin origin, TileDataPool* pool)
+    {
+        auto array = dynamic_cast<const vsg::Array2D<T>*>(&data);
+        if (!array || array->width() < 2 || array->height() < 2) return {};
+
+        uint32_t width = array->width();
+        uint32_t height = array->height();
+        bool flip = data.getLayout().origin != origin;
+
+        vsg::Data::Layout layout;
+        layout.format = VK_FORMAT_R32_SFLOAT;
+        layout.origin = origin;
+
+        auto heights = createArray2D<float>(pool, width, height, layout);
+        for (uint32_t j = 0; j < height; ++j)
+        {
+            uint32_t src_j = flip ? (height - 1 - j) : j;
+            for (uint32_t i = 0; i < width; ++i)
+            {
+                heights->set(i, j, static_cast<float>(array->at(i, src_j)));
+            }
+        }
+        return heights;
+    }
+
+    // place the odd vertices along the edges of the grid on the line between their neighbours, so the edges meet those of a neighbouring grid with half as many quads along its edges.
+    // Heights are included in the vertices so the displaced edges match as well as the ellipsoid's curvature.
+    void matchCoarserEdges(vsg::vec3* vertices, uint32_t numRows, uint32_t numCols)
+    {
+        auto midpoint = [&](uint32_t vi, uint32_t stride) { vertices[vi] = (vertices[vi - stride] + vertices[vi + stride]) * 0.5f; };
+
+        uint32_t topRow = (numRows - 1) * numCols;
+        for (uint32_t c = 1; c < numCols - 1; c += 2)
+        {
+            midpoint(c, 1);
+            midpoint(topRow + c, 1);
+        }
+        for (uint32_t r = 1; r < numRows - 1; r += 2)
+        {
+            midpoint(r * numCols, numCols);
+            midpoint(r * numCols + numCols - 1, numCols);
+        }
+    }
+
+    // set the skirt vertices that follow the numGridVertices grid vertices to depth below the perimeter vertices, along their normals when provided, otherwise towards the ellipsoid's center
+    void hangSkirts(vsg::vec3* vertices, vsg::vec3* normals, const std::vector<uint32_t>& perimeter, uint32_t numGridVertices, const vsg::vec3& ellipsoidCenter, float depth)
+    {
+        for (uint32_t i = 0; i < perimeter.size(); ++i)
+        {
+            const auto& vertex = vertices[perimeter[i]];
+            auto down = normals ? -normals[perimeter[i]] : vsg::normalize(ellipsoidCenter - vertex);
+            vertices[numGridVertices + i] = vertex + down * depth;
+            if (normals) normals[numGridVertices + i] = normals[perimeter[i]];
+        }
+    }
+
+    // depth of the skirts hung from a tile's edges, in metres, relative to the size of the tile
+    float computeSkirtDepth(const vsg::EllipsoidModel& ellipsoidModel, const std::vector<double>& latitudes, const std::vector<double>& longitudes, double skirtRatio)
+    {
+        double latitudeSpan = vsg::radians(latitudes.back() - latitudes.front());
+        double longitudeSpan = vsg::radians(longitudes.back() - longitudes.front()) * std::cos(vsg::radians((latitudes.front() + latitudes.back()) * 0.5));
+        return static_cast<float>(skirtRatio * ellipsoidModel.radiusEquator() * std::max(latitudeSpan, longitudeSpan));
+    }
+
+    // bounding sphere and horizon occlusion point of the grid of latitudes and longitudes, in degrees, displaced between minHeight and maxHeight.
+    // The sphere is centered on the normal through the tile's center, from where the distance to the displaced grid increases towards the grid's edges,
+    // so only the edges need sampling, other than for the coarse tiles that curve far enough round the ellipsoid that the whole grid is sampled.
+    vsg::ref_ptr<TileBound> computeGridBound(const vsg::EllipsoidModel& ellipsoidModel, const std::vector<double>& latitudes, const std::vector<double>& longitudes, const vsg::dvec3& centerLatLong, double minHeight, double maxHeight)
+    {
+        uint32_t numRows = static_cast<uint32_t>(latitudes.size());
+        uint32_t numCols = static_cast<uint32_t>(longitudes.size());
+        bool edgesOnly = (latitudes.back() - latitudes.front()) <= 45.0 && (longitudes.back() - longitudes.front()) <= 45.0;
+
+        std::vector<vsg::dvec3> lowerPoints, upperPoints;
+        for (uint32_t r = 0; r < numRows; ++r)
+        {
+            bool edgeRow = r == 0 || r == numRows - 1;
+            for (uint32_t c = 0; c < numCols; c += (edgesOnly && !edgeRow) ? (numCols - 1) : 1)
+            {
+                lowerPoints.push_back(ellipsoidModel.convertLatLongAltitudeToECEF(vsg::dvec3(latitudes[r], longitudes[c], minHeight)));
+                upperPoints.push_back(ellipsoidModel.convertLatLongAltitudeToECEF(vsg::dvec3(latitudes[r], longitudes[c], maxHeight)));
+            }
+        }
+
+        // center the sphere between the deepest and highest points along the tile's normal
+        vsg::dvec3 surfaceCenter = ellipsoidModel.convertLatLongAltitudeToECEF(vsg::dvec3(centerLatLong.x, centerLatLong.y, 0.0));
+        vsg::dvec3 normal = vsg::normalize(ellipsoidModel.convertLatLongAltitudeToECEF(vsg::dvec3(centerLatLong.x, centerLatLong.y, 1.0)) - surfaceCenter);
+        double minDistance = std::min(minHeight, 0.0);
+        double maxDistance = std::max(maxHeight, 0.0);
+        for (auto& points : {&lowerPoints, &upperPoints})
+        {
+            for (auto& point : *points)
+            {
+                double distance = vsg::dot(point - surfaceCenter, normal);
+                minDistance = std::min(minDistance, distance);
+                maxDistance = std::max(maxDistance, distance);
+            }
+        }
+
+        vsg::dvec3 center = surfaceCenter + normal * ((minDistance + maxDistance) * 0.5);
+        double radius = 0.0;
+        for (auto& points : {&lowerPoints, &upperPoints})
+        {
+            for (auto& point : *points) radius = std::max(radius, vsg::length(point - center));
+        }
+
+        auto bound = TileBound::create();
+        bound->sphere = vsg::dsphere(center, radius);
+
+        // the occlusion point lies along the direction of the tile's center in the ellipsoid's scaled space, far enough out that it's only hidden when all the tile's highest points are,
+        // points below the ellipsoid are treated as on it as they are hidden whenever the ellipsoid above them is
+        vsg::dvec3 scale(1.0 / ellipsoidModel.radiusEquator(), 1.0 / ellipsoidModel.radiusEquator(), 1.0 / ellipsoidModel.radiusPolar());
+        auto toScaledSpace = [&](const vsg::dvec3& v) { return vsg::dvec3(v.x * scale.x, v.y * scale.y, v.z * scale.z); };
+
+        vsg::dvec3 direction = vsg::normalize(toScaledSpace(surfaceCenter));
+        double maxMagnitude = 0.0;
+        for (uint32_t r = 0; r < numRows; ++r)
+        {
+            bool edgeRow = r == 0 || r == numRows - 1;
+            for (uint32_t c = 0; c < numCols; c += (edgesOnly && !edgeRow) ? (numCols - 1) : 1)
+            {
+                vsg::dvec3 position = toScaledSpace(ellipsoidModel.convertLatLongAltitudeToECEF(vsg::dvec3(latitudes[r], longitudes[c], std::max(maxHeight, 0.0))));
+                double magnitude = std::max(vsg::length(position), 1.0);
+                vsg::dvec3 positionDirection = vsg::normalize(position);
+
+                double cosAlpha = vsg::dot(positionDirection, direction);
+                double sinAlpha = vsg::length(vsg::cross(positionDirection, direction));
+                double cosBeta = 1.0 / magnitude;
+                double sinBeta = std::sqrt(magnitude * magnitude - 1.0) * cosBeta;
+
+                double denominator = cosAlpha * cosBeta - sinAlpha * sinBeta;
+                if (denominator <= 0.0) return bound;
+
+                maxMagnitude = std::max(maxMagnitude, 1.0 / denominator);
+            }
+        }
+
+        bound->horizonOcclusionPoint = direction * maxMagnitude;
+        bound->hasHorizonOcclusionPoint = true;
+
+        return bound;
+    }
+} // namespace
+
+vsg::ref_ptr<vsg::Data> TileReader::createHeightTexture(const vsg::Data& terrainData, vsg::Origin origin) const
+{
+    vsg::ref_ptr<vsg::Data> heights;
+    if ((heights = convertHeightField<float>(terrainData, origin, tileDataPool.get()))) return heights;
+    if ((heights = convertHeightField<double>(terrainData, origin, tileDataPool.get()))) return heights;
+    if ((heights = convertHeightField<int16_t>(terrainData, origin, tileDataPool.get()))) return heights;
+    if ((heights = convertHeightField<uint16_t>(terrainData, origin, tileDataPool.get()))) return heights;
+    if ((heights = convertHeightField<int32_t>(terrainData, origin, tileDataPool.get()))) return heights;
+    return convertHeightField<uint32_t>(terrainData, origin, tileDataPool.get());
+}
+
+vsg::ref_ptr<vsg::Commands> TileReader::getSharedGrid(const vsg::dbox& tile_extents, const std::vector<double>& latitudes, const std::vector<double>& longitudes, double centerLatitude, double centerLongitude) const
+{
+    // in the tile's local frame the flat grid only depends on the latitude range and the longitude width, so every tile in a row can share it
+    GridKey key(tile_extents.min.y, tile_extents.max.y, tile_extents.max.x - tile_extents.min.x);
+
+    std::scoped_lock<std::mutex> lock(sharedGridsMutex);
+
+    if (auto itr = sharedGrids.find(key); itr != sharedGrids.end()) return itr->second;
+
+    // discard grids that are no longer referenced by any tile
+    for (auto itr = sharedGrids.begin(); itr != sharedGrids.end();)
+    {
+        if (itr->second->referenceCount() == 1)
+            itr = sharedGrids.erase(itr);
+        else
+            ++itr;
+    }
+
+    // build the grid about longitude 0.0 so that it's independent of the tile's position along the row
+    std::vector<double> relativeLongitudes(longitudes.size());
+    for (size_t c = 0; c < longitudes.size(); ++c) relativeLongitudes[c] = longitudes[c] - centerLongitude;
+
+    auto localToWorld = settings->ellipsoidModel->computeLocalToWorldTransform(vsg::dvec3(centerLatitude, 0.0, 0.0));
+    auto worldToLocal = vsg::inverse(localToWorld);
+
+    bool matchParentEdges = false;
+    auto& tileGrid = selectGrid(tile_extents, &matchParentEdges);
+
+    uint32_t numRows = static_cast<uint32_t>(latitudes.size());
+    uint32_t numCols = static_cast<uint32_t>(longitudes.size());
+    uint32_t numVertices = tileGrid.numVertices();
+    auto vertices = vsg::vec3Array::create(numVertices);
+    auto normals = vsg::vec3Array::create(numVertices);
+    convertLatLongGridToLocal(*settings->ellipsoidModel, latitudes.data(), numRows, relativeLongitudes.data(), numCols, 0.0, worldToLocal, vertices->data());
+    computeLatLongGridNormals(latitudes.data(), numRows, relativeLongitudes.data(), numCols, worldToLocal, normals->data());
+    if (matchParentEdges) matchCoarserEdges(vertices->data(), numRows, numCols);
+
+    // the skirts are displaced along with their edge vertices, so hang them below the flat grid
+    if (!tileGrid.perimeter.empty())
+    {
+        float skirtDepth = computeSkirtDepth(*settings->ellipsoidModel, latitudes, longitudes, settings->skirtRatio);
+        hangSkirts(vertices->data(), normals->data(), tileGrid.perimeter, numRows * numCols, vsg::vec3(), skirtDepth);
+    }
+
+    auto grid = vsg::Commands::create();
+    grid->addChild(vsg::BindVertexBuffers::create(0, vsg::DataList{vertices}));
+    grid->addChild(vsg::BindVertexBuffers::create(2, vsg::DataList{normals}));
+
+    sharedGrids[key] = grid;
+
+    return grid;
+}
+
+bool TileReader::sampleHeights(const vsg::Data& terrainData, uint32_t numRows, uint32_t numCols, std::vector<float>& heights) const
+{
+    return sampleHeightField<float>(terrainData, numRows, numCols, heights) ||
+           sampleHeightField<double>(terrainData, numRows, numCols, heights) ||
+           sampleHeightField<int16_t>(terrainData, numRows, numCols, heights) ||
+           sampleHeightField<uint16_t>(terrainData, numRows, numCols, heights) ||
+           sampleHeightField<int32_t>(terrainData, numRows, numCols, heights) ||
+           sampleHeightField<uint32_t>(terrainData, numRows, numCols, heights);
+}
+
+vsg::ref_ptr<vsg::Data> TileReader::prepareTexture(vsg::ref_ptr<vsg::Data> textureData) const
+{
+    // images packed into texture arrays are copied into the arrays as read
+    if (!textureData || textureArrays) return textureData;
+
+    uint32_t numMipmaps = computeNumMipmaps(textureData->width(), textureData->height(), settings->mipmapLevelsHint, settings->minMipmapSize);
+
+    if (textureCompressionFormat != VK_FORMAT_UNDEFINED)
+    {
+        if (auto compressed = compressImage(*textureData, textureCompressionFormat, numMipmaps, tileDataPool.get())) return compressed;
+    }
+
+    // generateMipmaps() leaves tiles that already have mipmaps to be used as is
+    if (settings->cpuMipmaps)
+    {
+        if (auto mipmapped = generateMipmaps(*textureData, numMipmaps, settings->minMipmapSize, tileDataPool.get())) return mipmapped;
+    }
+
+    return textureData;
+}
+
+std::vector<vsg::ref_ptr<vsg::StateGroup>> TileReader::createTextureArrays(const vsg::DataList& images, const vsg::DataList& terrains, std::vector<TextureArrayLayer>& layers) const
+{
+    layers.clear();
+    layers.resize(images.size());
+
+    // heights are packed alongside the images so tiles need both to be compatible to share a batch
+    vsg::DataList heights(images.size());
+    if (gpuTerrainDisplacement)
+    {
+        for (size_t i = 0; i < images.size(); ++i)
+        {
+            if (!images[i]) continue;
+
+            auto origin = static_cast<vsg::Origin>(images[i]->getLayout().origin);
+            if (i < terrains.size() && terrains[i]) heights[i] = createHeightTexture(*terrains[i], origin);
+            if (!heights[i])
+            {
+                vsg::Data::Layout layout;
+                layout.format = VK_FORMAT_R32_SFLOAT;
+                layout.origin = origin;
+                heights[i] = vsg::floatArray2D::create(2, 2, 0.0f, layout);
+            }
+        }
+    }
+
+    struct Batch
+    {
+        std::vector<size_t> tiles;
+        vsg::DataList images;
+        vsg::DataList heights;
+    };
+
+    std::vector<Batch> batches;
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        if (!images[i]) continue;
+
+        auto itr = std::find_if(batches.begin(), batches.end(), [&](const Batch& batch) {
+            return compatibleTextureLayers(*batch.images.front(), *images[i]) && (!gpuTerrainDisplacement || compatibleTextureLayers(*batch.heights.front(), *heights[i]));
+        });
+        if (itr == batches.end()) itr = batches.insert(batches.end(), Batch{});
+
+        itr->tiles.push_back(i);
+        itr->images.push_back(images[i]);
+        if (gpuTerrainDisplacement) itr->heights.push_back(heights[i]);
+    }
+
+    std::vector<vsg::ref_ptr<vsg::StateGroup>> stateGroups;
+    for (auto& batch : batches)
+    {
+        auto imageArray = createTextureArray(batch.images, tileDataPool.get());
+        auto heightArray = gpuTerrainDisplacement ? createTextureArray(batch.heights, tileDataPool.get()) : vsg::ref_ptr<vsg::Data>();
+        if (!imageArray || (gpuTerrainDisplacement && !heightArray))
+        {
+            vsg::warn("TileReader::createTextureArrays() unsupported image or terrain data format, skipping ", batch.tiles.size(), " tiles.");
+            continue;
+        }
+
+        vsg::Descriptors descriptors{vsg::DescriptorImage::create(sampler, imageArray, 0, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)};
+        if (heightArray) descriptors.push_back(vsg::DescriptorImage::create(heightSampler, heightArray, 1, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER));
+
+        auto descriptorSet = vsg::DescriptorSet::create(descriptorSetLayout, descriptors);
+
+        auto stateGroup = vsg::StateGroup::create();
+        stateGroup->add(vsg::BindDescriptorSets::create(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, vsg::DescriptorSets{descriptorSet}));
+        stateGroups.push_back(stateGroup);
+
+        for (size_t l = 0; l < batch.tiles.size(); ++l)
+        {
+            layers[batch.tiles[l]] = TextureArrayLayer{stateGroup, static_cast<int32_t>(l)};
+        }
+    }
+
+    return stateGroups;
 }
 
 vsg::ref_ptr<vsg::StateGroup> TileReader::createRoot() const
@@ -416,107 +1973,227 @@ vsg::ref_ptr<vsg::StateGroup> TileReader::createRoot() const
     return root;
 }
 
-vsg::ref_ptr<vsg::Node> TileReader::createTile(const vsg::dbox& tile_extents, vsg::ref_ptr<vsg::Data> sourceData) const
+vsg::ref_ptr<vsg::Node> TileReader::createTile(const vsg::dbox& tile_extents, vsg::ref_ptr<vsg::Data> sourceData, vsg::ref_ptr<vsg::Data> terrainData, int32_t textureLayer) const
 {
+    auto start_prepare = vsg::clock::now();
+    auto textureData = prepareTexture(sourceData);
+    auto start_create = vsg::clock::now();
+    loadStats->add(TileLoadStats::PREPARE_TEXTURE, start_prepare, start_create);
 #if 1
-    return createECEFTile(tile_extents, sourceData);
+    auto tile = createECEFTile(tile_extents, textureData, terrainData, textureLayer);
 #else
-    return createTextureQuad(tile_extents, sourceData);
+    auto tile = createTextureQuad(tile_extents, textureData);
 #endif
+    loadStats->add(TileLoadStats::CREATE_TILE, start_create, vsg::clock::now());
+
+    if (tile)
+    {
+        // estimate of the memory used by the tile, mipmaps generated on the GPU add a third to the image, shared grids aren't counted
+        uint64_t size = textureData->dataSize();
+        if (textureData->getLayout().maxNumMipmaps > 1)
+            size = uint64_t(textureData->computeValueCountIncludingMipmaps()) * textureData->valueSize();
+        else if (settings->mipmapLevelsHint > 1)
+            size += size / 3;
+        if (terrainData) size += terrainData->dataSize();
+        if (!gpuTerrainDisplacement)
+        {
+            auto& grid = selectGrid(tile_extents);
+            size += grid.numRows * grid.numCols * sizeof(vsg::vec3);
+        }
+
+        tile->setObject("ResidentTile", ResidentTile::create(this, size));
+
+        // keep what the placeholders of the tile's subtiles are drawn with, the descriptor set bound by the tile's StateGroup
+        auto stateGroup = tile.cast<vsg::StateGroup>();
+        if (incrementalRefinement && stateGroup && !stateGroup->stateCommands.empty())
+        {
+            auto parentTile = ParentTile::create();
+            parentTile->bindDescriptorSets = stateGroup->stateCommands.front();
+            parentTile->origin = textureData->getLayout().origin;
+            parentTile->extents = tile_extents;
+            parentTile->terrain = terrainData;
+            tile->setObject("ParentTile", parentTile);
+        }
+    }
+
+    return tile;
 }
 
-vsg::ref_ptr<vsg::Node> TileReader::createECEFTile(const vsg::dbox& tile_extents, vsg::ref_ptr<vsg::Data> textureData) const
+vsg::ref_ptr<vsg::Node> TileReader::createECEFTile(const vsg::dbox& tile_extents, vsg::ref_ptr<vsg::Data> textureData, vsg::ref_ptr<vsg::Data> terrainData, int32_t textureLayer, const ParentTile* parentTile) const
 {
     vsg::dvec3 center = computeLatitudeLongitudeAltitude((tile_extents.min + tile_extents.max) * 0.5);
 
     auto localToWorld = settings->ellipsoidModel->computeLocalToWorldTransform(center);
     auto worldToLocal = vsg::inverse(localToWorld);
 
-    // create texture image and associated DescriptorSets and binding
-    auto texture = vsg::DescriptorImage::create(sampler, textureData, 0, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+    // set up model transformation node
+    auto transform = vsg::MatrixTransform::create(localToWorld); // VK_SHADER_STAGE_VERTEX_BIT
 
-    auto descriptorSet = vsg::DescriptorSet::create(descriptorSetLayout, vsg::Descriptors{texture});
-    auto bindDescriptorSets = vsg::BindDescriptorSets::create(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, vsg::DescriptorSets{descriptorSet});
+    // tiles in a texture array batch only select their layer, the arrays are bound by the batch's StateGroup
+    vsg::ref_ptr<vsg::Node> scenegraph = transform;
+    if (parentTile)
+    {
+        // placeholders share the parent's texture, and height texture when displacing on the GPU, which are already compiled
+        auto stateGroup = vsg::StateGroup::create();
+        stateGroup->add(parentTile->bindDescriptorSets);
+        stateGroup->addChild(transform);
 
-    // create StateGroup to bind any texture state
-    auto scenegraph = vsg::StateGroup::create();
-    scenegraph->add(bindDescriptorSets);
+        scenegraph = stateGroup;
+    }
+    else if (textureLayer < 0)
+    {
+        // create texture image, and height texture when displacing on the GPU, and associated DescriptorSets and binding
+        auto texture = vsg::DescriptorImage::create(sampler, textureData, 0, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
 
-    // set up model transformation node
-    auto transform = vsg::MatrixTransform::create(localToWorld); // VK_SHADER_STAGE_VERTEX_BIT
+        vsg::Descriptors descriptors{texture};
+        if (gpuTerrainDisplacement)
+        {
+            vsg::ref_ptr<vsg::Data> heights;
+            if (terrainData && !(heights = createHeightTexture(*terrainData, static_cast<vsg::Origin>(textureData->getLayout().origin))))
+            {
+                vsg::warn("TileReader::createECEFTile() unsupported terrain data format, creating flat tile.");
+            }
 
-    // add transform to root of the scene graph
-    scenegraph->addChild(transform);
+            if (heights)
+                descriptors.push_back(vsg::DescriptorImage::create(heightSampler, heights, 1, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER));
+            else
+                descriptors.push_back(flatHeightTexture);
+        }
+
+        auto descriptorSet = vsg::DescriptorSet::create(descriptorSetLayout, descriptors);
+        auto bindDescriptorSets = vsg::BindDescriptorSets::create(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, vsg::DescriptorSets{descriptorSet});
+
+        // create StateGroup to bind any texture state
+        auto stateGroup = vsg::StateGroup::create();
+        stateGroup->add(bindDescriptorSets);
+
+        // add transform to root of the scene graph
+        stateGroup->addChild(transform);
 
-    uint32_t numRows = 32;
-    uint32_t numCols = 32;
-    uint32_t numVertices = numRows * numCols;
-    uint32_t numTriangles = (numRows - 1) * (numCols - 1) * 2;
+        scenegraph = stateGroup;
+    }
+
+    bool matchParentEdges = false;
+    auto& grid = selectGrid(tile_extents, &matchParentEdges);
+
+    uint32_t numRows = grid.numRows;
+    uint32_t numCols = grid.numCols;
+    uint32_t numGridVertices = numRows * numCols;
+    uint32_t numVertices = grid.numVertices();
 
     double longitudeOrigin = tile_extents.min.x;
     double longitudeScale = (tile_extents.max.x - tile_extents.min.x) / double(numCols - 1);
     double latitudeOrigin = tile_extents.min.y;
     double latitudeScale = (tile_extents.max.y - tile_extents.min.y) / double(numRows - 1);
 
-    float sCoordScale = 1.0f / float(numCols - 1);
-    float tCoordScale = 1.0f / float(numRows - 1);
-    float tCoordOrigin = 0.0;
-    if (textureData->getLayout().origin == vsg::TOP_LEFT)
+    // the grid is separable in latitude and longitude so compute the per row latitudes and per column longitudes and convert the whole grid in one call
+    std::vector<double> latitudes(numRows);
+    std::vector<double> longitudes(numCols);
+    for (uint32_t r = 0; r < numRows; ++r) latitudes[r] = computeLatitudeLongitudeAltitude(vsg::dvec3(longitudeOrigin, latitudeOrigin + double(r) * latitudeScale, 0.0)).x;
+    for (uint32_t c = 0; c < numCols; ++c) longitudes[c] = computeLatitudeLongitudeAltitude(vsg::dvec3(longitudeOrigin + double(c) * longitudeScale, latitudeOrigin, 0.0)).y;
+
+    vsg::ref_ptr<vsg::BindVertexBuffers> bindTexCoords;
+    if (parentTile)
     {
-        tCoordScale = -tCoordScale;
-        tCoordOrigin = 1.0f;
+        // texcoords of the tile's region of the parent's image, the GPU displacement samples the parent's heights with the same texcoords
+        auto& parentExtents = parentTile->extents;
+        double parentWidth = parentExtents.max.x - parentExtents.min.x;
+        double parentHeight = parentExtents.max.y - parentExtents.min.y;
+        float sCoordOrigin = float((tile_extents.min.x - parentExtents.min.x) / parentWidth);
+        float sCoordScale = float((tile_extents.max.x - tile_extents.min.x) / parentWidth) / float(numCols - 1);
+        float tCoordOrigin = float((tile_extents.min.y - parentExtents.min.y) / parentHeight);
+        float tCoordScale = float((tile_extents.max.y - tile_extents.min.y) / parentHeight) / float(numRows - 1);
+        bool topLeft = parentTile->origin == vsg::TOP_LEFT;
+
+        auto texcoords = createArray<vsg::vec2>(tileDataPool.get(), numVertices);
+        for (uint32_t r = 0; r < numRows; ++r)
+        {
+            float t = tCoordOrigin + float(r) * tCoordScale;
+            for (uint32_t c = 0; c < numCols; ++c)
+            {
+                texcoords->set(c + r * numCols, vsg::vec2(sCoordOrigin + float(c) * sCoordScale, topLeft ? 1.0f - t : t));
+            }
+        }
+        for (uint32_t i = 0; i < grid.perimeter.size(); ++i) texcoords->set(numGridVertices + i, texcoords->at(grid.perimeter[i]));
+        bindTexCoords = vsg::BindVertexBuffers::create(1, vsg::DataList{texcoords});
+    }
+    else
+    {
+        bindTexCoords = (textureData->getLayout().origin == vsg::TOP_LEFT) ? grid.bindTexCoordsTopLeft : grid.bindTexCoordsBottomLeft;
     }
 
-    vsg::vec3 color(1.0f, 1.0f, 1.0f);
-
-    // set up vertex coords
-    auto vertices = vsg::vec3Array::create(numVertices);
-    auto colors = vsg::vec3Array::create(numVertices);
-    auto texcoords = vsg::vec2Array::create(numVertices);
-    for (uint32_t r = 0; r < numRows; ++r)
+    // sample the terrain, if any, at the grid vertices, to displace them along the ellipsoid normal on the CPU and to bound the tile either way
+    std::vector<float> heights;
+    if (terrainData && !sampleHeights(*terrainData, numRows, numCols, heights) && !gpuTerrainDisplacement)
     {
-        for (uint32_t c = 0; c < numCols; ++c)
-        {
-            vsg::dvec3 location(longitudeOrigin + double(c) * longitudeScale, latitudeOrigin + double(r) * latitudeScale, 0.0);
-            vsg::dvec3 latitudeLongitudeAltitude = computeLatitudeLongitudeAltitude(location);
+        vsg::warn("TileReader::createECEFTile() unsupported terrain data format, creating flat tile.");
+    }
 
-            auto ecef = settings->ellipsoidModel->convertLatLongAltitudeToECEF(latitudeLongitudeAltitude);
-            vsg::vec3 vertex(worldToLocal * ecef);
-            vsg::vec2 texcoord(float(c) * sCoordScale, tCoordOrigin + float(r) * tCoordScale);
+    // setup geometry
+    auto drawCommands = vsg::Commands::create();
+    if (textureLayer >= 0)
+    {
+        // the layer is a per instance vertex attribute, keeping the push constants within the 128 bytes every device supports
+        auto layers = createArray<uint32_t>(tileDataPool.get(), 1);
+        layers->set(0, static_cast<uint32_t>(textureLayer));
+        drawCommands->addChild(vsg::BindVertexBuffers::create(4, vsg::DataList{layers}));
+    }
+    if (gpuTerrainDisplacement)
+    {
+        // the vertex shader displaces the shared flat grid, so no per tile geometry is required
+        drawCommands->addChild(getSharedGrid(tile_extents, latitudes, longitudes, center.x, center.y));
 
-            uint32_t vi = c + r * numCols;
-            vertices->set(vi, vertex);
-            colors->set(vi, color);
-            texcoords->set(vi, texcoord);
+        // the heights of the matched edge vertices are interpolated from their neighbours' heights, the placeholders' texcoords are scaled to their region of the parent's
+        if (!matchParentEdges)
+        {
+            drawCommands->addChild(grid.bindNoEdgeOffsets);
+        }
+        else if (parentTile)
+        {
+            auto& parentExtents = parentTile->extents;
+            vsg::vec2 scale(float((tile_extents.max.x - tile_extents.min.x) / (parentExtents.max.x - parentExtents.min.x)), float((tile_extents.max.y - tile_extents.min.y) / (parentExtents.max.y - parentExtents.min.y)));
+            auto edgeOffsets = createArray<vsg::vec2>(tileDataPool.get(), numVertices);
+            for (uint32_t i = 0; i < numVertices; ++i) edgeOffsets->set(i, vsg::vec2(grid.edgeOffsets->at(i).x * scale.x, grid.edgeOffsets->at(i).y * scale.y));
+            drawCommands->addChild(vsg::BindVertexBuffers::create(3, vsg::DataList{edgeOffsets}));
+        }
+        else
+        {
+            drawCommands->addChild(grid.bindEdgeOffsets);
         }
     }
-
-    // set up indices
-    auto indices = vsg::ushortArray::create(numTriangles * 3);
-    auto itr = indices->begin();
-    for (uint32_t r = 0; r < numRows - 1; ++r)
+    else
     {
-        for (uint32_t c = 0; c < numCols - 1; ++c)
+        // set up vertex coords, the texcoords and indices are shared between all tiles
+        auto vertices = createArray<vsg::vec3>(tileDataPool.get(), numVertices);
+        convertLatLongGridToLocal(*settings->ellipsoidModel, latitudes.data(), numRows, longitudes.data(), numCols, 0.0, worldToLocal, vertices->data(), heights.empty() ? nullptr : heights.data());
+        if (matchParentEdges) matchCoarserEdges(vertices->data(), numRows, numCols);
+        if (!grid.perimeter.empty())
         {
-            uint32_t vi = c + r * numCols;
-            (*itr++) = vi;
-            (*itr++) = vi + 1;
-            (*itr++) = vi + numCols;
-            (*itr++) = vi + numCols;
-            (*itr++) = vi + 1;
-            (*itr++) = vi + numCols + 1;
+            vsg::vec3 ellipsoidCenter(worldToLocal * vsg::dvec3(0.0, 0.0, 0.0));
+            hangSkirts(vertices->data(), nullptr, grid.perimeter, numGridVertices, ellipsoidCenter, computeSkirtDepth(*settings->ellipsoidModel, latitudes, longitudes, settings->skirtRatio));
         }
-    }
 
-    // setup geometry
-    auto drawCommands = vsg::Commands::create();
-    drawCommands->addChild(vsg::BindVertexBuffers::create(0, vsg::DataList{vertices, colors, texcoords}));
-    drawCommands->addChild(vsg::BindIndexBuffer::create(indices));
-    drawCommands->addChild(vsg::DrawIndexed::create(indices->size(), 1, 0, 0, 0));
+        drawCommands->addChild(vsg::BindVertexBuffers::create(0, vsg::DataList{vertices}));
+    }
+    drawCommands->addChild(bindTexCoords);
+    drawCommands->addChild(grid.bindIndexBuffer);
+    drawCommands->addChild(grid.drawIndexed);
 
     // add drawCommands to transform
     transform->addChild(drawCommands);
 
+    // bound the tile from its grid and height range rather than traversing its vertices, the GPU displaced vertices aren't available to traverse
+    auto start_bounds = vsg::clock::now();
+    double minHeight = 0.0, maxHeight = 0.0;
+    if (!heights.empty())
+    {
+        auto [minItr, maxItr] = std::minmax_element(heights.begin(), heights.end());
+        minHeight = *minItr;
+        maxHeight = *maxItr;
+    }
+    scenegraph->setObject("TileBound", computeGridBound(*settings->ellipsoidModel, latitudes, longitudes, center, minHeight, maxHeight));
+    loadStats->add(TileLoadStats::COMPUTE_BOUNDS, start_bounds, vsg::clock::now());
+
     return scenegraph;
 }
 
@@ -557,12 +2234,6 @@ vsg::ref_ptr<vsg::Node> TileReader::createTextureQuad(const vsg::dbox& tile_exte
          {max_x, 0.0f, max_y},
          {min_x, 0.0f, max_y}}); // VK_FORMAT_R32G32B32_SFLOAT, VK_VERTEX_INPUT_RATE_INSTANCE, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
 
-    auto colors = vsg::vec3Array::create(
-        {{1.0f, 1.0f, 1.0f},
-         {1.0f, 1.0f, 1.0f},
-         {1.0f, 1.0f, 1.0f},
-         {1.0f, 1.0f, 1.0f}}); // VK_FORMAT_R32G32B32_SFLOAT, VK_VERTEX_INPUT_RATE_VERTEX, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
-
     uint8_t origin = textureData->getLayout().origin; // in Vulkan the origin is by default top left.
     float left = 0.0f;
     float right = 1.0f;
@@ -580,7 +2251,7 @@ vsg::ref_ptr<vsg::Node> TileReader::createTextureQuad(const vsg::dbox& tile_exte
 
     // setup geometry
     auto drawCommands = vsg::Commands::create();
-    drawCommands->addChild(vsg::BindVertexBuffers::create(0, vsg::DataList{vertices, colors, texcoords}));
+    drawCommands->addChild(vsg::BindVertexBuffers::create(0, vsg::DataList{vertices, texcoords}));
     drawCommands->addChild(vsg::BindIndexBuffer::create(indices));
     drawCommands->addChild(vsg::DrawIndexed::create(6, 1, 0, 0, 0));
 
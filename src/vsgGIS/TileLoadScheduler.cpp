@@ -0,0 +1,212 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/TileLoadScheduler.h>
+
+#include <algorithm>
+
+using namespace vsgGIS;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  TileLoadScheduler
+//
+TileLoadScheduler::TileLoadScheduler(uint32_t numThreads, double in_prefetchTime, double in_cancelScreenHeightRatio) :
+    prefetchTime(in_prefetchTime),
+    cancelScreenHeightRatio(in_cancelScreenHeightRatio)
+{
+    for (uint32_t i = 0; i < std::max(numThreads, 1u); ++i)
+    {
+        _threads.emplace_back([this]() { _run(); });
+    }
+}
+
+TileLoadScheduler::~TileLoadScheduler()
+{
+    stop();
+}
+
+void TileLoadScheduler::setView(const vsg::dmat4& viewMatrix, const vsg::dmat4& projectionMatrix, double time)
+{
+    auto eyeToWorld = vsg::inverse(viewMatrix);
+    vsg::dvec3 eye = eyeToWorld * vsg::dvec3(0.0, 0.0, 0.0);
+    vsg::dvec3 direction = vsg::normalize(eyeToWorld * vsg::dvec3(0.0, 0.0, -1.0) - eye);
+
+    std::vector<vsg::ref_ptr<TileRequest>> cancelled;
+    {
+        std::scoped_lock<std::mutex> lock(_mutex);
+
+        // smooth the velocity over successive frames so a single uneven frame time doesn't throw the prediction off
+        if (_view.valid && time > _view.time)
+        {
+            vsg::dvec3 velocity = (eye - _view.eye) / (time - _view.time);
+            _view.velocity = (_view.velocity + velocity) * 0.5;
+        }
+        else if (!_view.valid)
+        {
+            _view.velocity.set(0.0, 0.0, 0.0);
+        }
+
+        _view.valid = true;
+        _view.eye = eye;
+        _view.direction = direction;
+        _view.projectionScale = std::abs(projectionMatrix[1][1]);
+        _view.time = time;
+
+        // the camera has moved since the requests were ranked so rank them against the view as it is now, dropping those no longer needed
+        size_t numRemaining = 0;
+        for (auto& pending : _pending)
+        {
+            bool stale = false;
+            pending.priority = _priority(_view, *pending.request, stale);
+            if (stale)
+                cancelled.push_back(pending.request);
+            else
+                _pending[numRemaining++] = pending;
+        }
+        _pending.resize(numRemaining);
+        std::make_heap(_pending.begin(), _pending.end());
+    }
+
+    for (auto& stale : cancelled) stale->cancel();
+    numCancelled += cancelled.size();
+}
+
+void TileLoadScheduler::add(vsg::ref_ptr<TileRequest> request)
+{
+    bool added = false;
+    {
+        std::scoped_lock<std::mutex> lock(_mutex);
+        bool stale = false;
+        double priority = _priority(_view, *request, stale);
+        if (_active && !stale)
+        {
+            _pending.push_back(Pending{priority, _sequence++, request});
+            std::push_heap(_pending.begin(), _pending.end());
+            if (request->prefetch) ++numPrefetched;
+            added = true;
+        }
+    }
+
+    if (!added)
+    {
+        // already stopped so there's no thread left to run the request, or already out of view
+        request->cancel();
+        ++numCancelled;
+        return;
+    }
+
+    _condition.notify_one();
+}
+
+void TileLoadScheduler::stop()
+{
+    std::vector<Pending> cancelled;
+    std::vector<std::thread> threads;
+    {
+        std::scoped_lock<std::mutex> lock(_mutex);
+        _active = false;
+        cancelled.swap(_pending);
+        threads.swap(_threads);
+    }
+
+    _condition.notify_all();
+
+    for (auto& thread : threads) thread.join();
+
+    for (auto& pending : cancelled) pending.request->cancel();
+    numCancelled += cancelled.size();
+}
+
+double TileLoadScheduler::screenHeightRatio(const vsg::dsphere& bound) const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _view.valid ? _screenHeightRatio(_view, bound, _view.eye) : 0.0;
+}
+
+double TileLoadScheduler::predictedScreenHeightRatio(const vsg::dsphere& bound) const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _view.valid ? _screenHeightRatio(_view, bound, _view.eye + _view.velocity * prefetchTime) : 0.0;
+}
+
+size_t TileLoadScheduler::numPending() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    return _pending.size();
+}
+
+double TileLoadScheduler::_screenHeightRatio(const View& view, const vsg::dsphere& bound, const vsg::dvec3& eye) const
+{
+    // same measure as the PagedLOD transitions use, the fraction of the window height the bound covers, capped when the eye is within the bound
+    double distance = std::max(vsg::length(bound.center - eye), bound.radius);
+    return distance > 0.0 ? bound.radius * view.projectionScale / distance : 0.0;
+}
+
+double TileLoadScheduler::_priority(const View& view, const TileRequest& request, bool& stale) const
+{
+    stale = false;
+
+    // view independent requests rank above any screen height ratio, and without a view load coarse levels first so there is always something to see
+    if (request.bound.radius <= 0.0) return 1.0e9 - double(request.level);
+    if (!view.valid) return -double(request.level);
+
+    auto weighted = [&](const vsg::dvec3& eye) {
+        double ratio = _screenHeightRatio(view, request.bound, eye);
+
+        // favour tiles near the centre of the view, tiles behind the eye keep half their priority as the view may be turning towards them
+        vsg::dvec3 delta = request.bound.center - eye;
+        double distance = vsg::length(delta);
+        double cosAngle = distance > 0.0 ? vsg::dot(delta, view.direction) / distance : 1.0;
+        return std::pair<double, double>(ratio, ratio * (0.75 + 0.25 * cosAngle));
+    };
+
+    auto current = weighted(view.eye);
+    auto predicted = (prefetchTime > 0.0) ? weighted(view.eye + view.velocity * prefetchTime) : current;
+
+    stale = cancelScreenHeightRatio > 0.0 && current.first < cancelScreenHeightRatio && predicted.first < cancelScreenHeightRatio;
+
+    double priority = std::max(current.second, predicted.second);
+    return request.prefetch ? priority * 0.5 : priority;
+}
+
+void TileLoadScheduler::_run()
+{
+    for (;;)
+    {
+        vsg::ref_ptr<TileRequest> request;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() { return !_active || !_pending.empty(); });
+            if (!_active) return;
+
+            // the requests were ranked by the latest setView() so the highest priority request is at the top of the heap
+            std::pop_heap(_pending.begin(), _pending.end());
+            request = _pending.back().request;
+            _pending.pop_back();
+        }
+
+        request->run();
+        ++numCompleted;
+    }
+}
@@ -0,0 +1,207 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/TileLoadStats.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+using namespace vsgGIS;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  LoadHistogram
+//
+void LoadHistogram::add(uint64_t value)
+{
+    // bucket index is the bit width of the value
+    size_t i = 0;
+    while (i < numBuckets - 1 && (value >> i) != 0) ++i;
+
+    _buckets[i].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _total.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t previous = _maximum.load(std::memory_order_relaxed);
+    while (value > previous && !_maximum.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {}
+}
+
+double LoadHistogram::mean() const
+{
+    uint64_t n = count();
+    return n > 0 ? double(total()) / double(n) : 0.0;
+}
+
+double LoadHistogram::percentile(double fraction) const
+{
+    uint64_t n = count();
+    if (n == 0) return 0.0;
+
+    double target = std::clamp(fraction, 0.0, 1.0) * double(n);
+    double accumulated = 0.0;
+    for (size_t i = 0; i < numBuckets; ++i)
+    {
+        double inBucket = double(bucket(i));
+        if (inBucket > 0.0 && accumulated + inBucket >= target)
+        {
+            double lower = (i == 0) ? 0.0 : double(uint64_t(1) << (i - 1));
+            double upper = (i == 0) ? 1.0 : double(uint64_t(1) << i);
+            double value = lower + (upper - lower) * (target - accumulated) / inBucket;
+            return std::min(value, double(maximum()));
+        }
+        accumulated += inBucket;
+    }
+    return double(maximum());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  TileLoadStats
+//
+TileLoadStats::TileLoadStats(size_t in_maxTraceEvents) :
+    maxTraceEvents(in_maxTraceEvents),
+    _startTime(std::chrono::steady_clock::now()),
+    _traceEvents(in_maxTraceEvents)
+{
+}
+
+const char* TileLoadStats::name(Stage stage)
+{
+    switch (stage)
+    {
+    case (FETCH_QUEUED): return "fetch_queued";
+    case (FETCH): return "fetch";
+    case (TILE_CACHE_READ): return "tile_cache_read";
+    case (FETCH_WAIT): return "fetch_wait";
+    case (PREPARE_TEXTURE): return "prepare_texture";
+    case (CREATE_TILE): return "create_tile";
+    case (COMPUTE_BOUNDS): return "compute_bounds";
+    case (READ_SUBTILE): return "read_subtile";
+    case (UPLOAD_WAIT): return "upload_wait";
+    default: return "unknown";
+    }
+}
+
+const char* TileLoadStats::name(Counter counter)
+{
+    switch (counter)
+    {
+    case (MEMORY_CACHE_HIT): return "memory_cache_hit";
+    case (MEMORY_CACHE_MISS): return "memory_cache_miss";
+    case (TILE_CACHE_HIT): return "tile_cache_hit";
+    case (TILE_CACHE_MISS): return "tile_cache_miss";
+    case (FETCH_FAILED): return "fetch_failed";
+    default: return "unknown";
+    }
+}
+
+uint32_t TileLoadStats::threadIndex()
+{
+    // small sequential thread ids keep the trace readable
+    thread_local const TileLoadStats* owner = nullptr;
+    thread_local uint32_t index = 0;
+    if (owner != this)
+    {
+        owner = this;
+        index = _numThreads.fetch_add(1, std::memory_order_relaxed);
+    }
+    return index;
+}
+
+void TileLoadStats::add(Stage stage, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    _stages[stage].add(static_cast<uint64_t>(std::max(duration, decltype(duration)(0))));
+
+    if (maxTraceEvents == 0) return;
+
+    // once the trace is full the events are dropped, the histograms keep accumulating
+    size_t i = _numTraceEvents.fetch_add(1, std::memory_order_relaxed);
+    if (i < maxTraceEvents)
+    {
+        _traceEvents[i] = TraceEvent{stage, threadIndex(), std::chrono::duration_cast<std::chrono::microseconds>(start - _startTime).count(), duration};
+    }
+}
+
+void TileLoadStats::print(std::ostream& out) const
+{
+    out << std::left << std::setw(18) << "stage" << std::right << std::setw(10) << "count" << std::setw(12) << "mean ms" << std::setw(12) << "p50 ms" << std::setw(12) << "p90 ms" << std::setw(12) << "p99 ms" << std::setw(12) << "max ms" << std::endl;
+    for (uint32_t s = 0; s < NUM_STAGES; ++s)
+    {
+        auto& h = _stages[s];
+        out << std::left << std::setw(18) << name(Stage(s)) << std::right << std::setw(10) << h.count() << std::fixed << std::setprecision(3)
+            << std::setw(12) << h.mean() * 0.001 << std::setw(12) << h.percentile(0.5) * 0.001 << std::setw(12) << h.percentile(0.9) * 0.001
+            << std::setw(12) << h.percentile(0.99) * 0.001 << std::setw(12) << double(h.maximum()) * 0.001 << std::endl;
+    }
+
+    out << std::left << std::setw(18) << "fetched_bytes" << std::right << std::setw(10) << _fetchedBytes.count() << "  mean " << _fetchedBytes.mean() << ", total " << _fetchedBytes.total() << std::endl;
+
+    for (uint32_t c = 0; c < NUM_COUNTERS; ++c)
+    {
+        out << std::left << std::setw(18) << name(Counter(c)) << std::right << std::setw(10) << count(Counter(c)) << std::endl;
+    }
+}
+
+bool TileLoadStats::writeCSV(const vsg::Path& filename) const
+{
+    std::ofstream fout(filename.string());
+    if (!fout) return false;
+
+    fout << "name,count,mean_ms,p50_ms,p90_ms,p99_ms,max_ms" << std::endl;
+    for (uint32_t s = 0; s < NUM_STAGES; ++s)
+    {
+        auto& h = _stages[s];
+        fout << name(Stage(s)) << "," << h.count() << "," << h.mean() * 0.001 << "," << h.percentile(0.5) * 0.001 << "," << h.percentile(0.9) * 0.001 << ","
+             << h.percentile(0.99) * 0.001 << "," << double(h.maximum()) * 0.001 << std::endl;
+    }
+
+    // sizes and counters share the count column, the byte sizes go in the value columns unscaled
+    fout << "fetched_bytes," << _fetchedBytes.count() << "," << _fetchedBytes.mean() << "," << _fetchedBytes.percentile(0.5) << "," << _fetchedBytes.percentile(0.9) << ","
+         << _fetchedBytes.percentile(0.99) << "," << _fetchedBytes.maximum() << std::endl;
+    for (uint32_t c = 0; c < NUM_COUNTERS; ++c)
+    {
+        fout << name(Counter(c)) << "," << count(Counter(c)) << ",,,,," << std::endl;
+    }
+
+    return fout.good();
+}
+
+bool TileLoadStats::writeChromeTrace(const vsg::Path& filename) const
+{
+    std::ofstream fout(filename.string());
+    if (!fout) return false;
+
+    // complete events, "ph":"X", with timestamps and durations in microseconds from the creation of the stats. Events still being recorded may be incomplete so write once loading is idle.
+    size_t numEvents = std::min(_numTraceEvents.load(), maxTraceEvents);
+    fout << "{\"traceEvents\":[" << std::endl;
+    for (size_t i = 0; i < numEvents; ++i)
+    {
+        auto& event = _traceEvents[i];
+        fout << "{\"name\":\"" << name(event.stage) << "\",\"cat\":\"vsgGIS\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.threadIndex << ",\"ts\":" << event.start << ",\"dur\":" << event.duration << "}";
+        fout << ((i + 1 < numEvents) ? ",\n" : "\n");
+    }
+    fout << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+
+    return fout.good();
+}
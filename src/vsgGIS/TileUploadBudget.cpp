@@ -0,0 +1,74 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/TileUploadBudget.h>
+
+using namespace vsgGIS;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  TileUploadBudget
+//
+TileUploadBudget::TileUploadBudget(uint64_t in_bytesPerFrame, double in_maxWait) :
+    bytesPerFrame(in_bytesPerFrame),
+    maxWait(in_maxWait)
+{
+}
+
+void TileUploadBudget::advanceFrame(uint64_t frameCount)
+{
+    {
+        std::scoped_lock<std::mutex> lock(_mutex);
+        if (_started && frameCount == _frameCount) return;
+
+        _started = true;
+        _frameCount = frameCount;
+        _used = 0;
+        _frameTime = std::chrono::steady_clock::now();
+    }
+
+    ++numFrames;
+    _condition.notify_all();
+}
+
+void TileUploadBudget::acquire(uint64_t bytes)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    // the frame's budget always admits the first tiles so a single oversized request can't block forever
+    auto fits = [&]() { return _used == 0 || _used + bytes <= bytesPerFrame; };
+
+    if (_started && !fits())
+    {
+        ++numDeferred;
+
+        auto stall = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(maxWait));
+        while (!fits() && std::chrono::steady_clock::now() - _frameTime < stall)
+        {
+            _condition.wait_until(lock, _frameTime + stall);
+        }
+    }
+
+    _used += bytes;
+    numBytes += bytes;
+}
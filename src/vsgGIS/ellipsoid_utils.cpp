@@ -0,0 +1,139 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/ellipsoid_utils.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace vsgGIS;
+
+void vsgGIS::convertLatLongGridToLocal(const vsg::EllipsoidModel& ellipsoidModel, const double* latitudes, uint32_t numRows, const double* longitudes, uint32_t numCols, double altitude, const vsg::dmat4& worldToLocal, vsg::vec3* vertices, const float* heights)
+{
+    const double radiusEquator = ellipsoidModel.radiusEquator();
+    const double radiusPolar = ellipsoidModel.radiusPolar();
+    const double eccentricitySquared = 1.0 - (radiusPolar * radiusPolar) / (radiusEquator * radiusEquator);
+
+    const auto& m = worldToLocal;
+
+    // ECEF = ((N + h) * cos(lat) * cos(lon), (N + h) * cos(lat) * sin(lon), (N * (1 - e^2) + h) * sin(lat)) so the rotation from ECEF into the local frame
+    // can be folded into per column terms, stored as structure of arrays, and a per row scale and offset.
+    std::vector<double> columnTerms(numCols * 3);
+    double* column_x = columnTerms.data();
+    double* column_y = column_x + numCols;
+    double* column_z = column_y + numCols;
+
+    for (uint32_t c = 0; c < numCols; ++c)
+    {
+        double longitude = vsg::radians(longitudes[c]);
+        double cosLongitude = std::cos(longitude);
+        double sinLongitude = std::sin(longitude);
+
+        column_x[c] = m[0][0] * cosLongitude + m[1][0] * sinLongitude;
+        column_y[c] = m[0][1] * cosLongitude + m[1][1] * sinLongitude;
+        column_z[c] = m[0][2] * cosLongitude + m[1][2] * sinLongitude;
+    }
+
+    for (uint32_t r = 0; r < numRows; ++r)
+    {
+        double latitude = vsg::radians(latitudes[r]);
+        double sinLatitude = std::sin(latitude);
+        double cosLatitude = std::cos(latitude);
+        double N = radiusEquator / std::sqrt(1.0 - eccentricitySquared * sinLatitude * sinLatitude);
+
+        double scale = (N + altitude) * cosLatitude;
+        double z = (N * (1.0 - eccentricitySquared) + altitude) * sinLatitude;
+
+        double offset_x = m[2][0] * z + m[3][0];
+        double offset_y = m[2][1] * z + m[3][1];
+        double offset_z = m[2][2] * z + m[3][2];
+
+        vsg::vec3* row = vertices + r * numCols;
+        if (heights)
+        {
+            // displacement along the ellipsoid normal, (cos(lat) * cos(lon), cos(lat) * sin(lon), sin(lat)), reuses the per column terms
+            const float* row_heights = heights + r * numCols;
+            double normal_x = m[2][0] * sinLatitude;
+            double normal_y = m[2][1] * sinLatitude;
+            double normal_z = m[2][2] * sinLatitude;
+            for (uint32_t c = 0; c < numCols; ++c)
+            {
+                double h = row_heights[c];
+                double s = scale + h * cosLatitude;
+                row[c].x = static_cast<float>(s * column_x[c] + offset_x + h * normal_x);
+                row[c].y = static_cast<float>(s * column_y[c] + offset_y + h * normal_y);
+                row[c].z = static_cast<float>(s * column_z[c] + offset_z + h * normal_z);
+            }
+        }
+        else
+        {
+            for (uint32_t c = 0; c < numCols; ++c)
+            {
+                row[c].x = static_cast<float>(scale * column_x[c] + offset_x);
+                row[c].y = static_cast<float>(scale * column_y[c] + offset_y);
+                row[c].z = static_cast<float>(scale * column_z[c] + offset_z);
+            }
+        }
+    }
+}
+
+void vsgGIS::computeLatLongGridNormals(const double* latitudes, uint32_t numRows, const double* longitudes, uint32_t numCols, const vsg::dmat4& worldToLocal, vsg::vec3* normals)
+{
+    const auto& m = worldToLocal;
+
+    // normal = (cos(lat) * cos(lon), cos(lat) * sin(lon), sin(lat)), separable in the same way as convertLatLongGridToLocal()
+    std::vector<double> columnTerms(numCols * 3);
+    double* column_x = columnTerms.data();
+    double* column_y = column_x + numCols;
+    double* column_z = column_y + numCols;
+
+    for (uint32_t c = 0; c < numCols; ++c)
+    {
+        double longitude = vsg::radians(longitudes[c]);
+        double cosLongitude = std::cos(longitude);
+        double sinLongitude = std::sin(longitude);
+
+        column_x[c] = m[0][0] * cosLongitude + m[1][0] * sinLongitude;
+        column_y[c] = m[0][1] * cosLongitude + m[1][1] * sinLongitude;
+        column_z[c] = m[0][2] * cosLongitude + m[1][2] * sinLongitude;
+    }
+
+    for (uint32_t r = 0; r < numRows; ++r)
+    {
+        double latitude = vsg::radians(latitudes[r]);
+        double sinLatitude = std::sin(latitude);
+        double cosLatitude = std::cos(latitude);
+
+        double offset_x = m[2][0] * sinLatitude;
+        double offset_y = m[2][1] * sinLatitude;
+        double offset_z = m[2][2] * sinLatitude;
+
+        vsg::vec3* row = normals + r * numCols;
+        for (uint32_t c = 0; c < numCols; ++c)
+        {
+            row[c].x = static_cast<float>(cosLatitude * column_x[c] + offset_x);
+            row[c].y = static_cast<float>(cosLatitude * column_y[c] + offset_y);
+            row[c].z = static_cast<float>(cosLatitude * column_z[c] + offset_z);
+        }
+    }
+}
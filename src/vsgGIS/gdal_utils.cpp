@@ -27,9 +27,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <vsg/core/ConstVisitor.h>
 #include <vsg/core/Visitor.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
-#include <functional>
+#include <thread>
 
 using namespace vsgGIS;
 
@@ -101,86 +103,166 @@ bool vsgGIS::compatibleDatasetProjectionsTransformAndSizes(const GDALDataset& lh
     return true;
 }
 
-template<typename T>
-T default_value(double scale)
+vsgGIS::DatasetSignature::DatasetSignature(GDALDataset& dataset) :
+    width(dataset.GetRasterXSize()),
+    height(dataset.GetRasterYSize())
 {
-    if (std::numeric_limits<T>::is_integer)
+    const char* projectionRef = dataset.GetProjectionRef();
+    if (projectionRef && *projectionRef)
     {
-        if (scale < 0.0)
-            return std::numeric_limits<T>::min();
-        else if (scale > 0.0)
-            return std::numeric_limits<T>::max();
-        return static_cast<T>(0);
+        // hash the canonical WKT so equivalent projections written differently still match, falling back to the original string if it can't be parsed
+        std::string wkt(projectionRef);
+        OGRSpatialReference srs;
+        char* canonical = nullptr;
+        if (srs.importFromWkt(projectionRef) == OGRERR_NONE && srs.exportToWkt(&canonical) == OGRERR_NONE && canonical) wkt = canonical;
+        CPLFree(canonical);
+
+        projectionHash = std::hash<std::string>{}(wkt);
+        hasProjection = true;
     }
-    else
+
+    hasGeoTransform = dataset.GetGeoTransform(geoTransform.data()) == CE_None;
+}
+
+bool vsgGIS::DatasetSignature::compatibleProjection(const DatasetSignature& rhs) const
+{
+    return hasProjection == rhs.hasProjection && projectionHash == rhs.projectionHash;
+}
+
+bool vsgGIS::DatasetSignature::compatibleProjectionTransformAndSize(const DatasetSignature& rhs) const
+{
+    if (!compatibleProjection(rhs) || width != rhs.width || height != rhs.height || hasGeoTransform != rhs.hasGeoTransform) return false;
+    return !hasGeoTransform || geoTransform == rhs.geoTransform;
+}
+
+std::vector<std::shared_ptr<GDALDataset>> vsgGIS::openDataSets(const std::vector<vsg::Path>& filenames, GDALAccess access, uint32_t numThreads, std::vector<DatasetSignature>* signatures)
+{
+    std::vector<std::shared_ptr<GDALDataset>> datasets(filenames.size());
+    if (signatures) signatures->assign(filenames.size(), DatasetSignature());
+
+    // each thread takes the next file to open, the datasets are distinct so no further synchronization is required
+    std::atomic_size_t next{0};
+    auto open = [&]() {
+        for (size_t i = next++; i < filenames.size(); i = next++)
+        {
+            datasets[i] = openDataSet(filenames[i], access);
+            if (datasets[i] && signatures) (*signatures)[i] = DatasetSignature(*datasets[i]);
+        }
+    };
+
+    uint32_t threadCount = static_cast<uint32_t>(std::clamp<size_t>(numThreads, 1, std::max<size_t>(filenames.size(), 1)));
+    std::vector<std::thread> threads;
+    for (uint32_t t = 1; t < threadCount; ++t) threads.emplace_back(open);
+    open();
+
+    for (auto& thread : threads) thread.join();
+
+    return datasets;
+}
+
+std::shared_ptr<GDALDataset> vsgGIS::createMosaic(const std::vector<std::shared_ptr<GDALDataset>>& datasets, const vsg::Path& filename)
+{
+    std::vector<GDALDatasetH> handles;
+    for (auto& dataset : datasets)
     {
-        return static_cast<T>(scale);
+        if (dataset) handles.push_back(dataset.get());
     }
+    if (handles.empty()) return {};
+
+    auto mosaic = GDALBuildVRT(filename.string().c_str(), static_cast<int>(handles.size()), handles.data(), nullptr, nullptr, nullptr);
+    if (!mosaic) return {};
+
+    // the VRT is only written out when flushed, so flush it now for other threads to be able to open the file
+    if (!filename.empty()) GDALFlushCache(mosaic);
+
+    return std::shared_ptr<GDALDataset>(static_cast<GDALDataset*>(mosaic), [](GDALDataset* dataset) { GDALClose(dataset); });
 }
 
-template<typename T>
-vsg::t_vec2<T> default_vec2(const vsg::dvec4& value)
+// map the GDALDataType and number of components onto ImageTraits<T, N> at compile time, calling create(traits) with the matching instantiation
+template<typename T, class Create>
+static vsg::ref_ptr<vsg::Data> dispatchComponents(int numComponents, Create create)
 {
-    return vsg::t_vec2<T>(default_value<T>(value[0]), default_value<T>(value[1]));
+    switch (numComponents)
+    {
+    case (1): return create(vsgGIS::ImageTraits<T, 1>{});
+    case (2): return create(vsgGIS::ImageTraits<T, 2>{});
+    case (3): return create(vsgGIS::ImageTraits<T, 3>{});
+    case (4): return create(vsgGIS::ImageTraits<T, 4>{});
+    default: return {};
+    }
 }
 
-template<typename T>
-vsg::t_vec3<T> default_vec3(const vsg::dvec4& value)
+template<class Create>
+static vsg::ref_ptr<vsg::Data> dispatchImage2D(GDALDataType dataType, int numComponents, Create create)
 {
-    return vsg::t_vec3<T>(default_value<T>(value[0]), default_value<T>(value[1]), default_value<T>(value[2]));
+    switch (dataType)
+    {
+    case (GDT_Byte): return dispatchComponents<uint8_t>(numComponents, create);
+    case (GDT_UInt16): return dispatchComponents<uint16_t>(numComponents, create);
+    case (GDT_Int16): return dispatchComponents<int16_t>(numComponents, create);
+    case (GDT_UInt32): return dispatchComponents<uint32_t>(numComponents, create);
+    case (GDT_Int32): return dispatchComponents<int32_t>(numComponents, create);
+    case (GDT_Float32): return dispatchComponents<float>(numComponents, create);
+    case (GDT_Float64): return dispatchComponents<double>(numComponents, create);
+    default: return {};
+    }
 }
 
-template<typename T>
-vsg::t_vec4<T> default_vec4(const vsg::dvec4& value)
+vsg::ref_ptr<vsg::Data> vsgGIS::createImage2D(int width, int height, int numComponents, GDALDataType dataType, vsg::dvec4 def)
 {
-    return vsg::t_vec4<T>(default_value<T>(value[0]), default_value<T>(value[1]), default_value<T>(value[2]), default_value<T>(value[4]));
+    return dispatchImage2D(dataType, numComponents, [&](auto traits) -> vsg::ref_ptr<vsg::Data> {
+        using Traits = decltype(traits);
+        return createImage2D<typename Traits::component_type, Traits::numComponents>(width, height, def);
+    });
 }
 
-vsg::ref_ptr<vsg::Data> vsgGIS::createImage2D(int width, int height, int numComponents, GDALDataType dataType, vsg::dvec4 def)
+vsg::ref_ptr<vsg::Data> vsgGIS::createImage2D(int width, int height, int numComponents, GDALDataType dataType, vsg::ref_ptr<vsg::Data> storage, size_t offset, vsg::dvec4 def)
 {
-    using TypeCompontents = std::pair<GDALDataType, int>;
-    using CreateFunction = std::function<vsg::ref_ptr<vsg::Data>(uint32_t w, uint32_t h, vsg::dvec4 def)>;
-
-    std::map<TypeCompontents, CreateFunction> createMap;
-    createMap[TypeCompontents(GDT_Byte, 1)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::ubyteArray2D::create(w, h, default_value<uint8_t>(d[0]), vsg::Data::Layout{VK_FORMAT_R8_UNORM}); };
-    createMap[TypeCompontents(GDT_UInt16, 1)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::ushortArray2D::create(w, h, default_value<uint16_t>(d[0]), vsg::Data::Layout{VK_FORMAT_R16_UNORM}); };
-    createMap[TypeCompontents(GDT_Int16, 1)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::shortArray2D::create(w, h, default_value<int16_t>(d[0]), vsg::Data::Layout{VK_FORMAT_R16_SNORM}); };
-    createMap[TypeCompontents(GDT_UInt32, 1)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::uintArray2D::create(w, h, default_value<uint32_t>(d[0]), vsg::Data::Layout{VK_FORMAT_R32_UINT}); };
-    createMap[TypeCompontents(GDT_Int32, 1)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::intArray2D::create(w, h, default_value<int32_t>(d[0]), vsg::Data::Layout{VK_FORMAT_R32_SINT}); };
-    createMap[TypeCompontents(GDT_Float32, 1)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::floatArray2D::create(w, h, default_value<float>(d[0]), vsg::Data::Layout{VK_FORMAT_R32_SFLOAT}); };
-    createMap[TypeCompontents(GDT_Float64, 1)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::doubleArray2D::create(w, h, default_value<double>(d[0]), vsg::Data::Layout{VK_FORMAT_R64_SFLOAT}); };
-
-    createMap[TypeCompontents(GDT_Byte, 2)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::ubvec2Array2D::create(w, h, default_vec2<uint8_t>(d), vsg::Data::Layout{VK_FORMAT_R8G8_UNORM}); };
-    createMap[TypeCompontents(GDT_UInt16, 2)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::usvec2Array2D::create(w, h, default_vec2<uint16_t>(d), vsg::Data::Layout{VK_FORMAT_R16G16_UNORM}); };
-    createMap[TypeCompontents(GDT_Int16, 2)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::svec2Array2D::create(w, h, default_vec2<int16_t>(d), vsg::Data::Layout{VK_FORMAT_R16G16_SNORM}); };
-    createMap[TypeCompontents(GDT_UInt32, 2)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::uivec2Array2D::create(w, h, default_vec2<uint32_t>(d), vsg::Data::Layout{VK_FORMAT_R32G32_UINT}); };
-    createMap[TypeCompontents(GDT_Int32, 2)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::ivec2Array2D::create(w, h, default_vec2<int32_t>(d), vsg::Data::Layout{VK_FORMAT_R32G32_SINT}); };
-    createMap[TypeCompontents(GDT_Float32, 2)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::vec2Array2D::create(w, h, default_vec2<float>(d), vsg::Data::Layout{VK_FORMAT_R32G32_SFLOAT}); };
-    createMap[TypeCompontents(GDT_Float64, 2)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::dvec2Array2D::create(w, h, default_vec2<double>(d), vsg::Data::Layout{VK_FORMAT_R64G64_SFLOAT}); };
-
-    createMap[TypeCompontents(GDT_Byte, 3)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::ubvec3Array2D::create(w, h, default_vec3<uint8_t>(d), vsg::Data::Layout{VK_FORMAT_R8G8B8_UNORM}); };
-    createMap[TypeCompontents(GDT_UInt16, 3)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::usvec3Array2D::create(w, h, default_vec3<uint16_t>(d), vsg::Data::Layout{VK_FORMAT_R16G16B16_UNORM}); };
-    createMap[TypeCompontents(GDT_Int16, 3)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::svec3Array2D::create(w, h, default_vec3<int16_t>(d), vsg::Data::Layout{VK_FORMAT_R16G16B16_SNORM}); };
-    createMap[TypeCompontents(GDT_UInt32, 3)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::uivec3Array2D::create(w, h, default_vec3<uint32_t>(d), vsg::Data::Layout{VK_FORMAT_R32G32B32_UINT}); };
-    createMap[TypeCompontents(GDT_Int32, 3)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::ivec3Array2D::create(w, h, default_vec3<int32_t>(d), vsg::Data::Layout{VK_FORMAT_R32G32B32_SINT}); };
-    createMap[TypeCompontents(GDT_Float32, 3)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::vec3Array2D::create(w, h, default_vec3<float>(d), vsg::Data::Layout{VK_FORMAT_R32G32B32_SFLOAT}); };
-    createMap[TypeCompontents(GDT_Float64, 3)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::dvec3Array2D::create(w, h, default_vec3<double>(d), vsg::Data::Layout{VK_FORMAT_R64G64B64_SFLOAT}); };
-
-    createMap[TypeCompontents(GDT_Byte, 4)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::ubvec4Array2D::create(w, h, default_vec4<uint8_t>(d), vsg::Data::Layout{VK_FORMAT_R8G8B8A8_UNORM}); };
-    createMap[TypeCompontents(GDT_UInt16, 4)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::usvec4Array2D::create(w, h, default_vec4<uint16_t>(d), vsg::Data::Layout{VK_FORMAT_R16G16B16A16_UNORM}); };
-    createMap[TypeCompontents(GDT_Int16, 4)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::svec4Array2D::create(w, h, default_vec4<int16_t>(d), vsg::Data::Layout{VK_FORMAT_R16G16B16A16_SNORM}); };
-    createMap[TypeCompontents(GDT_UInt32, 4)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::uivec4Array2D::create(w, h, default_vec4<uint32_t>(d), vsg::Data::Layout{VK_FORMAT_R32G32B32A32_UINT}); };
-    createMap[TypeCompontents(GDT_Int32, 4)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::ivec4Array2D::create(w, h, default_vec4<int32_t>(d), vsg::Data::Layout{VK_FORMAT_R32G32B32A32_SINT}); };
-    createMap[TypeCompontents(GDT_Float32, 4)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::vec4Array2D::create(w, h, default_vec4<float>(d), vsg::Data::Layout{VK_FORMAT_R32G32B32A32_SFLOAT}); };
-    createMap[TypeCompontents(GDT_Float64, 4)] = [](uint32_t w, uint32_t h, vsg::dvec4 d) { return vsg::dvec4Array2D::create(w, h, default_vec4<double>(d), vsg::Data::Layout{VK_FORMAT_R64G64B64A64_SFLOAT}); };
-
-    auto itr = createMap.find(TypeCompontents(dataType, numComponents));
-    if (itr == createMap.end())
+    return dispatchImage2D(dataType, numComponents, [&](auto traits) -> vsg::ref_ptr<vsg::Data> {
+        using Traits = decltype(traits);
+        return createImage2D<typename Traits::component_type, Traits::numComponents>(width, height, storage, offset, def);
+    });
+}
+
+static int dataTypeSize(GDALDataType dataType)
+{
+    switch (dataType)
     {
-        return {};
+    case (GDT_Byte): return 1;
+    case (GDT_UInt16):
+    case (GDT_Int16): return 2;
+    case (GDT_UInt32):
+    case (GDT_Int32):
+    case (GDT_Float32): return 4;
+    case (GDT_Float64): return 8;
+    default:
+        return 0;
     }
+}
 
-    return (itr->second)(width, height, def);
+// copy count elements of type T from a packed source to a destination with a stride in bytes, T is only used for its size so the copy compiles to fixed size loads and stores
+template<typename T>
+static void interleave(const uint8_t* source_ptr, uint8_t* dest_ptr, int count, int stride)
+{
+    if (stride == static_cast<int>(sizeof(T)))
+    {
+        std::memcpy(dest_ptr, source_ptr, count * sizeof(T));
+        return;
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        std::memcpy(dest_ptr, source_ptr, sizeof(T));
+        source_ptr += sizeof(T);
+        dest_ptr += stride;
+    }
+}
+
+// return true if the window of the image's dimensions at xOffset, yOffset lies within a raster of the specified size
+static bool windowWithinRaster(const vsg::Data& image, int xOffset, int yOffset, int rasterXSize, int rasterYSize)
+{
+    return xOffset >= 0 && yOffset >= 0 && image.width() > 0 && image.height() > 0 &&
+           static_cast<int64_t>(xOffset) + image.width() <= rasterXSize && static_cast<int64_t>(yOffset) + image.height() <= rasterYSize;
 }
 
 bool vsgGIS::copyRasterBandToImage(GDALRasterBand& band, vsg::Data& image, int component)
@@ -190,67 +272,237 @@ bool vsgGIS::copyRasterBandToImage(GDALRasterBand& band, vsg::Data& image, int c
         return false;
     }
 
-    int dataSize = 0;
-    switch (band.GetRasterDataType())
+    return copyRasterBandWindowToImage(band, 0, 0, image, component);
+}
+
+bool vsgGIS::copyRasterBandWindowToImage(GDALRasterBand& band, int xOffset, int yOffset, vsg::Data& image, int component)
+{
+    if (!windowWithinRaster(image, xOffset, yOffset, band.GetXSize(), band.GetYSize())) return false;
+
+    int dataSize = dataTypeSize(band.GetRasterDataType());
+    if (dataSize == 0) return false;
+
+    int width = image.width();
+    int height = image.height();
+    GSpacing stride = image.getLayout().stride;
+    GSpacing lineSpace = stride * width;
+    uint8_t* dest_ptr = reinterpret_cast<uint8_t*>(image.dataPointer()) + dataSize * component;
+
+    // let GDAL write the band straight into the interleaved image, avoiding the intermediate block copy
+    if (band.RasterIO(GF_Read, xOffset, yOffset, width, height, dest_ptr, width, height, band.GetRasterDataType(), stride, lineSpace) == CE_None)
+    {
+        return true;
+    }
+
+    return copyRasterBandWindowToImageByBlocks(band, xOffset, yOffset, image, component);
+}
+
+bool vsgGIS::copyRasterBandToImageByBlocks(GDALRasterBand& band, vsg::Data& image, int component)
+{
+    if (image.width() != static_cast<uint32_t>(band.GetXSize()) || image.height() != static_cast<uint32_t>(band.GetYSize()))
     {
-    case (GDT_Byte): dataSize = 1; break;
-    case (GDT_UInt16):
-    case (GDT_Int16): dataSize = 2; break;
-    case (GDT_UInt32):
-    case (GDT_Int32):
-    case (GDT_Float32): dataSize = 4; break;
-    case (GDT_Float64): dataSize = 8; break;
-    default:
         return false;
     }
 
+    return copyRasterBandWindowToImageByBlocks(band, 0, 0, image, component);
+}
+
+bool vsgGIS::copyRasterBandWindowToImageByBlocks(GDALRasterBand& band, int xOffset, int yOffset, vsg::Data& image, int component)
+{
+    if (!windowWithinRaster(image, xOffset, yOffset, band.GetXSize(), band.GetYSize())) return false;
+
+    int dataSize = dataTypeSize(band.GetRasterDataType());
+    if (dataSize == 0) return false;
+
     int offset = dataSize * component;
     int stride = image.getLayout().stride;
 
+    using InterleaveFunction = void (*)(const uint8_t* source_ptr, uint8_t* dest_ptr, int count, int stride);
+    InterleaveFunction interleaveRow = nullptr;
+    switch (dataSize)
+    {
+    case (1): interleaveRow = interleave<uint8_t>; break;
+    case (2): interleaveRow = interleave<uint16_t>; break;
+    case (4): interleaveRow = interleave<uint32_t>; break;
+    default: interleaveRow = interleave<uint64_t>; break;
+    }
+
     int nBlockXSize, nBlockYSize;
     band.GetBlockSize(&nBlockXSize, &nBlockYSize);
 
-    int nXBlocks = (band.GetXSize() + nBlockXSize - 1) / nBlockXSize;
-    int nYBlocks = (band.GetYSize() + nBlockYSize - 1) / nBlockYSize;
+    // only the blocks that overlap the window are read
+    int windowXEnd = xOffset + static_cast<int>(image.width());
+    int windowYEnd = yOffset + static_cast<int>(image.height());
+    int firstXBlock = xOffset / nBlockXSize;
+    int firstYBlock = yOffset / nBlockYSize;
+    int lastXBlock = (windowXEnd - 1) / nBlockXSize;
+    int lastYBlock = (windowYEnd - 1) / nBlockYSize;
 
-    uint8_t* block = new uint8_t[dataSize * nBlockXSize * nBlockYSize];
+    std::vector<uint8_t> block(dataSize * nBlockXSize * nBlockYSize);
 
-    for (int iYBlock = 0; iYBlock < nYBlocks; iYBlock++)
+    for (int iYBlock = firstYBlock; iYBlock <= lastYBlock; iYBlock++)
     {
-        for (int iXBlock = 0; iXBlock < nXBlocks; iXBlock++)
+        for (int iXBlock = firstXBlock; iXBlock <= lastXBlock; iXBlock++)
         {
             int nXValid, nYValid;
-            CPLErr result = band.ReadBlock(iXBlock, iYBlock, block);
+            CPLErr result = band.ReadBlock(iXBlock, iYBlock, block.data());
             if (result == 0)
             {
                 // Compute the portion of the block that is valid
                 // for partial edge blocks.
                 band.GetActualBlockSize(iXBlock, iYBlock, &nXValid, &nYValid);
 
-                for (int iY = 0; iY < nYValid; iY++)
+                // clip the valid portion of the block to the window
+                int blockX = iXBlock * nBlockXSize;
+                int blockY = iYBlock * nBlockYSize;
+                int iXBegin = std::max(xOffset - blockX, 0);
+                int iXEnd = std::min(windowXEnd - blockX, nXValid);
+                int iYBegin = std::max(yOffset - blockY, 0);
+                int iYEnd = std::min(windowYEnd - blockY, nYValid);
+
+                for (int iY = iYBegin; iY < iYEnd; iY++)
                 {
-                    uint8_t* dest_ptr = reinterpret_cast<uint8_t*>(image.dataPointer(iXBlock * nBlockXSize + (iYBlock * nBlockYSize + iY) * image.width())) + offset;
-                    uint8_t* source_ptr = block + iY * nBlockXSize * dataSize;
-
-                    for (int iX = 0; iX < nXValid; iX++)
-                    {
-                        for (int c = 0; c < dataSize; ++c)
-                        {
-                            dest_ptr[c] = *source_ptr;
-                            ++source_ptr;
-                        }
-
-                        dest_ptr += stride;
-                    }
+                    uint8_t* dest_ptr = reinterpret_cast<uint8_t*>(image.dataPointer((blockX + iXBegin - xOffset) + (blockY + iY - yOffset) * image.width())) + offset;
+                    const uint8_t* source_ptr = block.data() + (iY * nBlockXSize + iXBegin) * dataSize;
+
+                    interleaveRow(source_ptr, dest_ptr, iXEnd - iXBegin, stride);
                 }
             }
         }
     }
-    delete[] block;
 
     return true;
 }
 
+bool vsgGIS::copyRasterBandsToImage(GDALDataset& dataset, const std::vector<int>& bands, vsg::Data& image, int firstComponent)
+{
+    if (image.width() != static_cast<uint32_t>(dataset.GetRasterXSize()) || image.height() != static_cast<uint32_t>(dataset.GetRasterYSize()))
+    {
+        return false;
+    }
+
+    return copyRasterBandsWindowToImage(dataset, bands, 0, 0, image, firstComponent);
+}
+
+bool vsgGIS::copyRasterBandsWindowToImage(GDALDataset& dataset, const std::vector<int>& bands, int xOffset, int yOffset, vsg::Data& image, int firstComponent)
+{
+    if (bands.empty()) return true;
+
+    if (!windowWithinRaster(image, xOffset, yOffset, dataset.GetRasterXSize(), dataset.GetRasterYSize())) return false;
+
+    GDALRasterBand* firstBand = dataset.GetRasterBand(bands.front());
+    if (!firstBand) return false;
+
+    GDALDataType dataType = firstBand->GetRasterDataType();
+    int dataSize = dataTypeSize(dataType);
+    if (dataSize == 0) return false;
+
+    GSpacing stride = image.getLayout().stride;
+    if (dataSize * (firstComponent + static_cast<int>(bands.size())) > stride) return false;
+
+    int width = image.width();
+    int height = image.height();
+    GSpacing lineSpace = stride * width;
+    uint8_t* dest_ptr = reinterpret_cast<uint8_t*>(image.dataPointer()) + dataSize * firstComponent;
+
+    // GDAL reads each block once and fans the bands out into the interleaved components
+    std::vector<int> bandMap(bands);
+    return dataset.RasterIO(GF_Read, xOffset, yOffset, width, height, dest_ptr, width, height, dataType,
+                            static_cast<int>(bandMap.size()), bandMap.data(), stride, lineSpace, dataSize) == CE_None;
+}
+
+// shared implementation of the parallel copies, when fullRaster is true the image must match the dimensions of the raster
+static bool parallelCopyRasterBandsToImage(const vsg::Path& filename, const std::vector<int>& bands, int xOffset, int yOffset, vsg::Data& image, int firstComponent, uint32_t numThreads, bool fullRaster)
+{
+    if (bands.empty()) return true;
+
+    auto dataset = openDataSet(filename, GA_ReadOnly);
+    if (!dataset) return false;
+
+    if (fullRaster && (image.width() != static_cast<uint32_t>(dataset->GetRasterXSize()) || image.height() != static_cast<uint32_t>(dataset->GetRasterYSize())))
+    {
+        return false;
+    }
+
+    if (numThreads <= 1) return vsgGIS::copyRasterBandsWindowToImage(*dataset, bands, xOffset, yOffset, image, firstComponent);
+
+    if (!windowWithinRaster(image, xOffset, yOffset, dataset->GetRasterXSize(), dataset->GetRasterYSize())) return false;
+
+    GDALRasterBand* firstBand = dataset->GetRasterBand(bands.front());
+    if (!firstBand) return false;
+
+    GDALDataType dataType = firstBand->GetRasterDataType();
+    int dataSize = dataTypeSize(dataType);
+    if (dataSize == 0) return false;
+
+    GSpacing stride = image.getLayout().stride;
+    if (dataSize * (firstComponent + static_cast<int>(bands.size())) > stride) return false;
+
+    // strips of whole block rows so that no block is decoded by more than one thread
+    int width = image.width();
+    int height = image.height();
+    int nBlockXSize, nBlockYSize;
+    firstBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    nBlockYSize = std::max(nBlockYSize, 1);
+
+    int stripHeight = nBlockYSize;
+    while (stripHeight < 64 && stripHeight < height) stripHeight += nBlockYSize;
+
+    // align the strips to the raster's block rows rather than the window
+    int firstStripY = (yOffset / stripHeight) * stripHeight;
+    int numStrips = (yOffset + height - firstStripY + stripHeight - 1) / stripHeight;
+
+    numThreads = std::min(numThreads, static_cast<uint32_t>(numStrips));
+
+    GSpacing lineSpace = stride * width;
+    uint8_t* image_ptr = reinterpret_cast<uint8_t*>(image.dataPointer()) + dataSize * firstComponent;
+
+    std::atomic<int> nextStrip{0};
+    std::atomic<bool> success{true};
+
+    auto readStrips = [&](std::shared_ptr<GDALDataset> local_dataset) {
+        if (!local_dataset) local_dataset = openDataSet(filename, GA_ReadOnly);
+        if (!local_dataset)
+        {
+            success = false;
+            return;
+        }
+
+        std::vector<int> bandMap(bands);
+        for (int strip = nextStrip++; strip < numStrips && success; strip = nextStrip++)
+        {
+            // rows of the window covered by this strip
+            int y = std::max(firstStripY + strip * stripHeight, yOffset);
+            int yEnd = std::min(firstStripY + (strip + 1) * stripHeight, yOffset + height);
+            int rows = yEnd - y;
+            if (local_dataset->RasterIO(GF_Read, xOffset, y, width, rows, image_ptr + (y - yOffset) * lineSpace, width, rows, dataType,
+                                        static_cast<int>(bandMap.size()), bandMap.data(), stride, lineSpace, dataSize) != CE_None)
+            {
+                success = false;
+            }
+        }
+    };
+
+    // the calling thread reuses the dataset opened above, the others open their own
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < numThreads; ++i) threads.emplace_back(readStrips, nullptr);
+    readStrips(dataset);
+
+    for (auto& thread : threads) thread.join();
+
+    return success;
+}
+
+bool vsgGIS::copyRasterBandsToImage(const vsg::Path& filename, const std::vector<int>& bands, vsg::Data& image, int firstComponent, uint32_t numThreads)
+{
+    return parallelCopyRasterBandsToImage(filename, bands, 0, 0, image, firstComponent, numThreads, true);
+}
+
+bool vsgGIS::copyRasterBandsWindowToImage(const vsg::Path& filename, const std::vector<int>& bands, int xOffset, int yOffset, vsg::Data& image, int firstComponent, uint32_t numThreads)
+{
+    return parallelCopyRasterBandsToImage(filename, bands, xOffset, yOffset, image, firstComponent, numThreads, false);
+}
+
 bool vsgGIS::assignMetaData(GDALDataset& dataset, vsg::Object& object)
 {
     auto metaData = dataset.GetMetadata();
@@ -7,11 +7,9 @@ layout(push_constant) uniform PushConstants {
 } pc;
 
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec2 inTexCoord;
+layout(location = 1) in vec2 inTexCoord;
 
-layout(location = 0) out vec3 fragColor;
-layout(location = 1) out vec2 fragTexCoord;
+layout(location = 0) out vec2 fragTexCoord;
 
 out gl_PerVertex {
     vec4 gl_Position;
@@ -19,6 +17,5 @@ out gl_PerVertex {
 
 void main() {
     gl_Position = (pc.projection * pc.modelview) * vec4(inPosition, 1.0);
-    fragColor = inColor;
     fragTexCoord = inTexCoord;
 }
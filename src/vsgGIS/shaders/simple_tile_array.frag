@@ -0,0 +1,13 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 0) uniform sampler2DArray texSampler;
+
+layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) flat in uint fragTextureLayer;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = texture(texSampler, vec3(fragTexCoord, float(fragTextureLayer)));
+}
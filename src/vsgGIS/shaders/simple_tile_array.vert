@@ -0,0 +1,24 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(push_constant) uniform PushConstants {
+    mat4 projection;
+    mat4 modelview;
+} pc;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 4) in uint inTextureLayer;
+
+layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) flat out uint fragTextureLayer;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+void main() {
+    gl_Position = (pc.projection * pc.modelview) * vec4(inPosition, 1.0);
+    fragTexCoord = inTexCoord;
+    fragTextureLayer = inTextureLayer;
+}
@@ -0,0 +1,52 @@
+#include <vsg/io/VSG.h>
+static auto simple_tile_array_frag = []() {std::istringstream str(
+R"(#vsga 0.5.0
+Root id=1 vsg::ShaderStage
+{
+  userObjects 0
+  stage 16
+  entryPointName "main"
+  module id=2 vsg::ShaderModule
+  {
+    userObjects 0
+    hints id=0
+    source "#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 0) uniform sampler2DArray texSampler;
+
+layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) flat in uint fragTextureLayer;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = texture(texSampler, vec3(fragTexCoord, float(fragTextureLayer)));
+}
+"
+    code 206
+     119734787 65536 524298 29 0 131089 1 393227 1 1280527431 1685353262 808793134
+     0 196622 0 1 524303 4 19 1852399981 0 7 14 17
+     196624 19 7 196611 2 450 589828 1096764487 1935622738 1918988389 1600484449 1684105331
+     1868526181 1667590754 29556 262149 19 1852399981 0 327685 7 1131705711 1919904879 0
+     327685 11 1400399220 1819307361 29285 393221 14 1734439526 1131963732 1685221231 0 458757
+     17 1734439526 1954047316 1281716853 1919252833 0 262215 7 30 0 262215 11
+     34 0 262215 11 33 0 262215 14 30 0 196679 17
+     14 262215 17 30 1 131091 2 196641 3 2 196630 4
+     32 262167 5 4 4 262176 6 3 5 262203 6 7
+     3 589849 8 4 1 0 1 0 1 0 196635 9
+     8 262176 10 0 9 262203 10 11 0 262167 12 4
+     2 262176 13 1 12 262203 13 14 1 262165 15 32
+     0 262176 16 1 15 262203 16 17 1 262167 18 4
+     3 327734 2 19 0 3 131320 20 262205 9 21 11
+     262205 12 22 14 262205 15 23 17 262256 4 24 23
+     327761 4 25 22 0 327761 4 26 22 1 393296 18
+     27 25 26 24 327767 5 28 21 27 196670 7 28
+     65789 65592
+  }
+  NumSpecializationConstants 0
+}
+)");
+vsg::VSG io;
+return io.read_cast<vsg::ShaderStage>(str);
+};
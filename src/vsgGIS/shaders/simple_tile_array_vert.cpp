@@ -0,0 +1,76 @@
+#include <vsg/io/VSG.h>
+static auto simple_tile_array_vert = []() {std::istringstream str(
+R"(#vsga 0.5.0
+Root id=1 vsg::ShaderStage
+{
+  userObjects 0
+  stage 1
+  entryPointName "main"
+  module id=2 vsg::ShaderModule
+  {
+    userObjects 0
+    hints id=0
+    source "#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(push_constant) uniform PushConstants {
+    mat4 projection;
+    mat4 modelview;
+} pc;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 4) in uint inTextureLayer;
+
+layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) flat out uint fragTextureLayer;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+void main() {
+    gl_Position = (pc.projection * pc.modelview) * vec4(inPosition, 1.0);
+    fragTexCoord = inTexCoord;
+    fragTextureLayer = inTextureLayer;
+}
+"
+    code 370
+     119734787 65536 524298 48 0 131089 1 393227 1 1280527431 1685353262 808793134
+     0 196622 0 1 720911 0 32 1852399981 0 8 19 24
+     26 29 31 196611 2 450 589828 1096764487 1935622738 1918988389 1600484449 1684105331
+     1868526181 1667590754 29556 262149 32 1852399981 0 393221 6 1348430951 1700164197 2019914866
+     0 393222 6 0 1348430951 1953067887 7237481 196613 8 0 393221 12
+     1752397136 1936617283 1953390964 115 393222 12 0 1785688688 1769235301 28271 393222 12
+     1 1701080941 1701410412 119 196613 14 25456 327685 19 1867542121 1769236851 28271
+     393221 24 1734439526 1131963732 1685221231 0 327685 26 1700032105 1869562744 25714 458757
+     29 1734439526 1954047316 1281716853 1919252833 0 393221 31 1700032105 1920300152 2036419685 29285
+     327752 6 0 11 0 196679 6 2 262216 12 0 5
+     327752 12 0 35 0 327752 12 0 7 16 262216 12
+     1 5 327752 12 1 35 64 327752 12 1 7 16
+     196679 12 2 262215 19 30 0 262215 24 30 0 262215
+     26 30 1 196679 29 14 262215 29 30 1 262215 31
+     30 4 131091 2 196641 3 2 196630 4 32 262167 5
+     4 4 196638 6 5 262176 7 3 6 262203 7 8
+     3 262165 9 32 1 262187 9 10 0 262168 11 5
+     4 262174 12 11 11 262176 13 9 12 262203 13 14
+     9 262176 15 9 11 262187 9 16 1 262167 17 4
+     3 262176 18 1 17 262203 18 19 1 262187 4 20
+     1065353216 262176 21 3 5 262167 22 4 2 262176 23 3
+     22 262203 23 24 3 262176 25 1 22 262203 25 26
+     1 262165 27 32 0 262176 28 3 27 262203 28 29
+     3 262176 30 1 27 262203 30 31 1 327734 2 32
+     0 3 131320 33 327745 15 34 14 10 262205 11 35
+     34 327745 15 36 14 16 262205 11 37 36 327826 11
+     38 35 37 262205 17 39 19 327761 4 40 39 0
+     327761 4 41 39 1 327761 4 42 39 2 458832 5
+     43 40 41 42 20 327825 5 44 38 43 327745 21
+     45 8 10 196670 45 44 262205 22 46 26 196670 24
+     46 262205 27 47 31 196670 29 47 65789 65592
+  }
+  NumSpecializationConstants 0
+}
+)");
+vsg::VSG io;
+return io.read_cast<vsg::ShaderStage>(str);
+};
@@ -0,0 +1,50 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(push_constant) uniform PushConstants {
+    mat4 projection;
+    mat4 modelview;
+} pc;
+
+layout(binding = 1) uniform sampler2DArray heightMap;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inEdgeOffset;
+layout(location = 4) in uint inTextureLayer;
+
+layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) flat out uint fragTextureLayer;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+// bilinear sample with the heightMap corners aligned to the grid corners, matching the CPU displacement
+float sampleHeight(vec2 texCoord)
+{
+    ivec2 size = textureSize(heightMap, 0).xy;
+    vec2 p = texCoord * vec2(size - ivec2(1));
+    ivec2 i = min(ivec2(p), size - ivec2(2));
+    vec2 r = p - vec2(i);
+
+    int layer = int(inTextureLayer);
+    float h00 = texelFetch(heightMap, ivec3(i, layer), 0).r;
+    float h10 = texelFetch(heightMap, ivec3(i + ivec2(1, 0), layer), 0).r;
+    float h01 = texelFetch(heightMap, ivec3(i + ivec2(0, 1), layer), 0).r;
+    float h11 = texelFetch(heightMap, ivec3(i + ivec2(1, 1), layer), 0).r;
+
+    return mix(mix(h00, h10, r.x), mix(h01, h11, r.x), r.y);
+}
+
+void main() {
+    // edge vertices matched to a coarser neighbour lie midway between their neighbours, as on the CPU
+    float height = sampleHeight(inTexCoord);
+    if (inEdgeOffset != vec2(0.0)) height = 0.5 * (sampleHeight(inTexCoord - inEdgeOffset) + sampleHeight(inTexCoord + inEdgeOffset));
+
+    vec3 position = inPosition + inNormal * height;
+    gl_Position = (pc.projection * pc.modelview) * vec4(position, 1.0);
+    fragTexCoord = inTexCoord;
+    fragTextureLayer = inTextureLayer;
+}
@@ -0,0 +1,167 @@
+#include <vsg/io/VSG.h>
+static auto simple_tile_displace_array_vert = []() {std::istringstream str(
+R"(#vsga 0.5.0
+Root id=1 vsg::ShaderStage
+{
+  userObjects 0
+  stage 1
+  entryPointName "main"
+  module id=2 vsg::ShaderModule
+  {
+    userObjects 0
+    hints id=0
+    source "#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(push_constant) uniform PushConstants {
+    mat4 projection;
+    mat4 modelview;
+} pc;
+
+layout(binding = 1) uniform sampler2DArray heightMap;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inEdgeOffset;
+layout(location = 4) in uint inTextureLayer;
+
+layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) flat out uint fragTextureLayer;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+// bilinear sample with the heightMap corners aligned to the grid corners, matching the CPU displacement
+float sampleHeight(vec2 texCoord)
+{
+    ivec2 size = textureSize(heightMap, 0).xy;
+    vec2 p = texCoord * vec2(size - ivec2(1));
+    ivec2 i = min(ivec2(p), size - ivec2(2));
+    vec2 r = p - vec2(i);
+
+    int layer = int(inTextureLayer);
+    float h00 = texelFetch(heightMap, ivec3(i, layer), 0).r;
+    float h10 = texelFetch(heightMap, ivec3(i + ivec2(1, 0), layer), 0).r;
+    float h01 = texelFetch(heightMap, ivec3(i + ivec2(0, 1), layer), 0).r;
+    float h11 = texelFetch(heightMap, ivec3(i + ivec2(1, 1), layer), 0).r;
+
+    return mix(mix(h00, h10, r.x), mix(h01, h11, r.x), r.y);
+}
+
+void main() {
+    // edge vertices matched to a coarser neighbour lie midway between their neighbours, as on the CPU
+    float height = sampleHeight(inTexCoord);
+    if (inEdgeOffset != vec2(0.0)) height = 0.5 * (sampleHeight(inTexCoord - inEdgeOffset) + sampleHeight(inTexCoord + inEdgeOffset));
+
+    vec3 position = inPosition + inNormal * height;
+    gl_Position = (pc.projection * pc.modelview) * vec4(position, 1.0);
+    fragTexCoord = inTexCoord;
+    fragTextureLayer = inTextureLayer;
+}
+"
+    code 1144
+     119734787 65536 524298 185 0 131089 1 131089 50 393227 1 1280527431
+     1685353262 808793134 0 196622 0 1 851983 0 58 1852399981 0 28
+     32 33 42 43 46 55 57 196611 2 450 589828 1096764487
+     1935622738 1918988389 1600484449 1684105331 1868526181 1667590754 29556 262149 58 1852399981 0 393221
+     101 1886216563 1699243372 1952999273 6714920 327685 102 1131963764 1685221231 0 262149 104
+     1702521203 0 327685 14 1734960488 1632466024 112 196613 105 112 196613 106
+     105 196613 107 114 262149 112 1702453612 114 393221 28 1700032105 1920300152
+     2036419685 29285 196613 108 3158120 196613 109 3158376 196613 110 3223656 196613
+     111 3223912 262149 60 1734960488 29800 327685 32 1700032105 1869562744 25714 262149
+     61 1634886000 109 393221 33 1682271849 1716479335 1952805734 0 262149 62 1634886000
+     109 262149 63 1634886000 109 327685 64 1769172848 1852795252 0 327685 42
+     1867542121 1769236851 28271 327685 43 1867411049 1818324338 0 393221 44 1348430951 1700164197
+     2019914866 0 393222 44 0 1348430951 1953067887 7237481 196613 46 0 393221
+     48 1752397136 1936617283 1953390964 115 393222 48 0 1785688688 1769235301 28271 393222
+     48 1 1701080941 1701410412 119 196613 50 25456 393221 55 1734439526 1131963732
+     1685221231 0 458757 57 1734439526 1954047316 1281716853 1919252833 0 262215 14 34
+     0 262215 14 33 1 262215 28 30 4 262215 32 30
+     1 262215 33 30 3 262215 42 30 0 262215 43 30
+     2 327752 44 0 11 0 196679 44 2 262216 48 0
+     5 327752 48 0 35 0 327752 48 0 7 16 262216
+     48 1 5 327752 48 1 35 64 327752 48 1 7
+     16 196679 48 2 262215 55 30 0 196679 57 14 262215
+     57 30 1 131091 2 196641 3 2 196630 4 32 262167
+     5 4 2 262176 6 7 5 262177 7 4 6 262165
+     8 32 1 262167 9 8 2 262176 10 7 9 589849
+     11 4 1 0 1 0 1 0 196635 12 11 262176
+     13 0 12 262203 13 14 0 262187 8 15 0 262167
+     16 8 3 262187 8 17 1 327724 9 18 17 17
+     262187 8 19 2 327724 9 20 19 19 262176 21 7
+     4 262176 22 7 8 262167 23 4 4 327724 9 24
+     17 15 327724 9 25 15 17 262165 26 32 0 262176
+     27 1 26 262203 27 28 1 262187 26 29 0 262187
+     26 30 1 262176 31 1 5 262203 31 32 1 262203
+     31 33 1 262187 4 34 0 327724 5 35 34 34
+     131092 36 262167 37 36 2 262187 4 38 1056964608 262167 39
+     4 3 262176 40 7 39 262176 41 1 39 262203 41
+     42 1 262203 41 43 1 196638 44 23 262176 45 3
+     44 262203 45 46 3 262168 47 23 4 262174 48 47
+     47 262176 49 9 48 262203 49 50 9 262176 51 9
+     47 262187 4 52 1065353216 262176 53 3 23 262176 54 3
+     5 262203 54 55 3 262176 56 3 26 262203 56 57
+     3 327734 2 58 0 3 131320 59 262203 21 60 7
+     262203 6 61 7 262203 6 62 7 262203 6 63 7
+     262203 40 64 7 262205 5 65 32 196670 61 65 327737
+     4 66 101 61 196670 60 66 262205 5 67 33 327863
+     37 68 67 35 262298 36 69 68 196855 81 0 262394
+     69 70 81 131320 70 262205 5 71 32 262205 5 72
+     33 327811 5 73 71 72 196670 62 73 327737 4 74
+     101 62 262205 5 75 32 262205 5 76 33 327809 5
+     77 75 76 196670 63 77 327737 4 78 101 63 327809
+     4 79 74 78 327813 4 80 38 79 196670 60 80
+     131321 81 131320 81 262205 39 82 42 262205 39 83 43
+     262205 4 84 60 327822 39 85 83 84 327809 39 86
+     82 85 196670 64 86 327745 51 87 50 15 262205 47
+     88 87 327745 51 89 50 17 262205 47 90 89 327826
+     47 91 88 90 262205 39 92 64 327761 4 93 92
+     0 327761 4 94 92 1 327761 4 95 92 2 458832
+     23 96 93 94 95 52 327825 23 97 91 96 327745
+     53 98 46 15 196670 98 97 262205 5 99 32 196670
+     55 99 262205 26 100 28 196670 57 100 65789 65592 327734
+     4 101 0 7 196663 6 102 131320 103 262203 10 104
+     7 262203 6 105 7 262203 10 106 7 262203 6 107
+     7 262203 21 108 7 262203 21 109 7 262203 21 110
+     7 262203 21 111 7 262203 22 112 7 262205 12 113
+     14 262244 11 114 113 327783 16 115 114 15 458831 9
+     116 115 115 0 1 196670 104 116 262205 5 117 102
+     262205 9 118 104 327810 9 119 118 18 262255 5 120
+     119 327813 5 121 117 120 196670 105 121 262205 5 122
+     105 262254 9 123 122 262205 9 124 104 327810 9 125
+     124 20 458764 9 126 1 39 123 125 196670 106 126
+     262205 5 127 105 262205 9 128 106 262255 5 129 128
+     327811 5 130 127 129 196670 107 130 262205 26 131 28
+     262268 8 132 131 196670 112 132 262205 12 133 14 262205
+     9 134 106 262205 8 135 112 327761 8 136 134 0
+     327761 8 137 134 1 393296 16 138 136 137 135 262244
+     11 139 133 458847 23 140 139 138 2 15 327761 4
+     141 140 0 196670 108 141 262205 12 142 14 262205 9
+     143 106 327808 9 144 143 24 262205 8 145 112 327761
+     8 146 144 0 327761 8 147 144 1 393296 16 148
+     146 147 145 262244 11 149 142 458847 23 150 149 148
+     2 15 327761 4 151 150 0 196670 109 151 262205 12
+     152 14 262205 9 153 106 327808 9 154 153 25 262205
+     8 155 112 327761 8 156 154 0 327761 8 157 154
+     1 393296 16 158 156 157 155 262244 11 159 152 458847
+     23 160 159 158 2 15 327761 4 161 160 0 196670
+     110 161 262205 12 162 14 262205 9 163 106 327808 9
+     164 163 18 262205 8 165 112 327761 8 166 164 0
+     327761 8 167 164 1 393296 16 168 166 167 165 262244
+     11 169 162 458847 23 170 169 168 2 15 327761 4
+     171 170 0 196670 111 171 262205 4 172 108 262205 4
+     173 109 327745 21 174 107 29 262205 4 175 174 524300
+     4 176 1 46 172 173 175 262205 4 177 110 262205
+     4 178 111 327745 21 179 107 29 262205 4 180 179
+     524300 4 181 1 46 177 178 180 327745 21 182 107
+     30 262205 4 183 182 524300 4 184 1 46 176 181
+     183 131326 184 65592
+  }
+  NumSpecializationConstants 0
+}
+)");
+vsg::VSG io;
+return io.read_cast<vsg::ShaderStage>(str);
+};
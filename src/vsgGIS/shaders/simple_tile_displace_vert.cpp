@@ -0,0 +1,149 @@
+#include <vsg/io/VSG.h>
+static auto simple_tile_displace_vert = []() {std::istringstream str(
+R"(#vsga 0.5.0
+Root id=1 vsg::ShaderStage
+{
+  userObjects 0
+  stage 1
+  entryPointName "main"
+  module id=2 vsg::ShaderModule
+  {
+    userObjects 0
+    hints id=0
+    source "#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(push_constant) uniform PushConstants {
+    mat4 projection;
+    mat4 modelview;
+} pc;
+
+layout(binding = 1) uniform sampler2D heightMap;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inEdgeOffset;
+
+layout(location = 0) out vec2 fragTexCoord;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+// bilinear sample with the heightMap corners aligned to the grid corners, matching the CPU displacement
+float sampleHeight(vec2 texCoord)
+{
+    ivec2 size = textureSize(heightMap, 0);
+    vec2 p = texCoord * vec2(size - ivec2(1));
+    ivec2 i = min(ivec2(p), size - ivec2(2));
+    vec2 r = p - vec2(i);
+
+    float h00 = texelFetch(heightMap, i, 0).r;
+    float h10 = texelFetch(heightMap, i + ivec2(1, 0), 0).r;
+    float h01 = texelFetch(heightMap, i + ivec2(0, 1), 0).r;
+    float h11 = texelFetch(heightMap, i + ivec2(1, 1), 0).r;
+
+    return mix(mix(h00, h10, r.x), mix(h01, h11, r.x), r.y);
+}
+
+void main() {
+    // edge vertices matched to a coarser neighbour lie midway between their neighbours, as on the CPU
+    float height = sampleHeight(inTexCoord);
+    if (inEdgeOffset != vec2(0.0)) height = 0.5 * (sampleHeight(inTexCoord - inEdgeOffset) + sampleHeight(inTexCoord + inEdgeOffset));
+
+    vec3 position = inPosition + inNormal * height;
+    gl_Position = (pc.projection * pc.modelview) * vec4(position, 1.0);
+    fragTexCoord = inTexCoord;
+}
+"
+    code 981
+     119734787 65536 524298 158 0 131089 1 131089 50 393227 1 1280527431
+     1685353262 808793134 0 196622 0 1 720911 0 52 1852399981 0 28
+     29 38 39 42 51 196611 2 450 589828 1096764487 1935622738 1918988389
+     1600484449 1684105331 1868526181 1667590754 29556 262149 52 1852399981 0 393221 94 1886216563
+     1699243372 1952999273 6714920 327685 95 1131963764 1685221231 0 262149 97 1702521203 0
+     327685 14 1734960488 1632466024 112 196613 98 112 196613 99 105 196613
+     100 114 196613 101 3158120 196613 102 3158376 196613 103 3223656 196613
+     104 3223912 262149 54 1734960488 29800 327685 28 1700032105 1869562744 25714 262149
+     55 1634886000 109 393221 29 1682271849 1716479335 1952805734 0 262149 56 1634886000
+     109 262149 57 1634886000 109 327685 58 1769172848 1852795252 0 327685 38
+     1867542121 1769236851 28271 327685 39 1867411049 1818324338 0 393221 40 1348430951 1700164197
+     2019914866 0 393222 40 0 1348430951 1953067887 7237481 196613 42 0 393221
+     44 1752397136 1936617283 1953390964 115 393222 44 0 1785688688 1769235301 28271 393222
+     44 1 1701080941 1701410412 119 196613 46 25456 393221 51 1734439526 1131963732
+     1685221231 0 262215 14 34 0 262215 14 33 1 262215 28
+     30 1 262215 29 30 3 262215 38 30 0 262215 39
+     30 2 327752 40 0 11 0 196679 40 2 262216 44
+     0 5 327752 44 0 35 0 327752 44 0 7 16
+     262216 44 1 5 327752 44 1 35 64 327752 44 1
+     7 16 196679 44 2 262215 51 30 0 131091 2 196641
+     3 2 196630 4 32 262167 5 4 2 262176 6 7
+     5 262177 7 4 6 262165 8 32 1 262167 9 8
+     2 262176 10 7 9 589849 11 4 1 0 0 0
+     1 0 196635 12 11 262176 13 0 12 262203 13 14
+     0 262187 8 15 0 262187 8 16 1 327724 9 17
+     16 16 262187 8 18 2 327724 9 19 18 18 262176
+     20 7 4 262167 21 4 4 327724 9 22 16 15
+     327724 9 23 15 16 262165 24 32 0 262187 24 25
+     0 262187 24 26 1 262176 27 1 5 262203 27 28
+     1 262203 27 29 1 262187 4 30 0 327724 5 31
+     30 30 131092 32 262167 33 32 2 262187 4 34 1056964608
+     262167 35 4 3 262176 36 7 35 262176 37 1 35
+     262203 37 38 1 262203 37 39 1 196638 40 21 262176
+     41 3 40 262203 41 42 3 262168 43 21 4 262174
+     44 43 43 262176 45 9 44 262203 45 46 9 262176
+     47 9 43 262187 4 48 1065353216 262176 49 3 21 262176
+     50 3 5 262203 50 51 3 327734 2 52 0 3
+     131320 53 262203 20 54 7 262203 6 55 7 262203 6
+     56 7 262203 6 57 7 262203 36 58 7 262205 5
+     59 28 196670 55 59 327737 4 60 94 55 196670 54
+     60 262205 5 61 29 327863 33 62 61 31 262298 32
+     63 62 196855 75 0 262394 63 64 75 131320 64 262205
+     5 65 28 262205 5 66 29 327811 5 67 65 66
+     196670 56 67 327737 4 68 94 56 262205 5 69 28
+     262205 5 70 29 327809 5 71 69 70 196670 57 71
+     327737 4 72 94 57 327809 4 73 68 72 327813 4
+     74 34 73 196670 54 74 131321 75 131320 75 262205 35
+     76 38 262205 35 77 39 262205 4 78 54 327822 35
+     79 77 78 327809 35 80 76 79 196670 58 80 327745
+     47 81 46 15 262205 43 82 81 327745 47 83 46
+     16 262205 43 84 83 327826 43 85 82 84 262205 35
+     86 58 327761 4 87 86 0 327761 4 88 86 1
+     327761 4 89 86 2 458832 21 90 87 88 89 48
+     327825 21 91 85 90 327745 49 92 42 15 196670 92
+     91 262205 5 93 28 196670 51 93 65789 65592 327734 4
+     94 0 7 196663 6 95 131320 96 262203 10 97 7
+     262203 6 98 7 262203 10 99 7 262203 6 100 7
+     262203 20 101 7 262203 20 102 7 262203 20 103 7
+     262203 20 104 7 262205 12 105 14 262244 11 106 105
+     327783 9 107 106 15 196670 97 107 262205 5 108 95
+     262205 9 109 97 327810 9 110 109 17 262255 5 111
+     110 327813 5 112 108 111 196670 98 112 262205 5 113
+     98 262254 9 114 113 262205 9 115 97 327810 9 116
+     115 19 458764 9 117 1 39 114 116 196670 99 117
+     262205 5 118 98 262205 9 119 99 262255 5 120 119
+     327811 5 121 118 120 196670 100 121 262205 12 122 14
+     262205 9 123 99 262244 11 124 122 458847 21 125 124
+     123 2 15 327761 4 126 125 0 196670 101 126 262205
+     12 127 14 262205 9 128 99 327808 9 129 128 22
+     262244 11 130 127 458847 21 131 130 129 2 15 327761
+     4 132 131 0 196670 102 132 262205 12 133 14 262205
+     9 134 99 327808 9 135 134 23 262244 11 136 133
+     458847 21 137 136 135 2 15 327761 4 138 137 0
+     196670 103 138 262205 12 139 14 262205 9 140 99 327808
+     9 141 140 17 262244 11 142 139 458847 21 143 142
+     141 2 15 327761 4 144 143 0 196670 104 144 262205
+     4 145 101 262205 4 146 102 327745 20 147 100 25
+     262205 4 148 147 524300 4 149 1 46 145 146 148
+     262205 4 150 103 262205 4 151 104 327745 20 152 100
+     25 262205 4 153 152 524300 4 154 1 46 150 151
+     153 327745 20 155 100 26 262205 4 156 155 524300 4
+     157 1 46 149 154 156 131326 157 65592
+  }
+  NumSpecializationConstants 0
+}
+)");
+vsg::VSG io;
+return io.read_cast<vsg::ShaderStage>(str);
+};
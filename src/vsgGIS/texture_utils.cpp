@@ -0,0 +1,519 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2021 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgGIS/texture_utils.h>
+
+#include <vsg/core/Array.h>
+#include <vsg/core/Array2D.h>
+#include <vsg/core/Array3D.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+using namespace vsgGIS;
+
+namespace
+{
+    struct MipmapLevel
+    {
+        uint32_t width;
+        uint32_t height;
+        std::vector<vsg::ubvec4> pixels;
+    };
+
+    // copy an 8 bit RGB or RGBA image into a RGBA level, return false if the image isn't supported
+    bool copyToLevel(const vsg::Data& image, MipmapLevel& level)
+    {
+        level.width = image.width();
+        level.height = image.height();
+        level.pixels.resize(level.width * level.height);
+
+        if (auto rgba = dynamic_cast<const vsg::ubvec4Array2D*>(&image))
+        {
+            std::copy(rgba->data(), rgba->data() + level.pixels.size(), level.pixels.begin());
+            return true;
+        }
+        else if (auto rgb = dynamic_cast<const vsg::ubvec3Array2D*>(&image))
+        {
+            const vsg::ubvec3* src = rgb->data();
+            for (auto& pixel : level.pixels)
+            {
+                pixel.set(src->r, src->g, src->b, 255);
+                ++src;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // 2x2 box filter down to the next mipmap level
+    void downsample(const MipmapLevel& src, MipmapLevel& dest)
+    {
+        dest.width = std::max(1u, src.width / 2);
+        dest.height = std::max(1u, src.height / 2);
+        dest.pixels.resize(dest.width * dest.height);
+
+        for (uint32_t j = 0; j < dest.height; ++j)
+        {
+            uint32_t j0 = std::min(j * 2, src.height - 1);
+            uint32_t j1 = std::min(j * 2 + 1, src.height - 1);
+            for (uint32_t i = 0; i < dest.width; ++i)
+            {
+                uint32_t i0 = std::min(i * 2, src.width - 1);
+                uint32_t i1 = std::min(i * 2 + 1, src.width - 1);
+
+                const auto& p00 = src.pixels[i0 + j0 * src.width];
+                const auto& p10 = src.pixels[i1 + j0 * src.width];
+                const auto& p01 = src.pixels[i0 + j1 * src.width];
+                const auto& p11 = src.pixels[i1 + j1 * src.width];
+
+                auto& d = dest.pixels[i + j * dest.width];
+                for (int c = 0; c < 4; ++c)
+                {
+                    d[c] = static_cast<uint8_t>((uint32_t(p00[c]) + uint32_t(p10[c]) + uint32_t(p01[c]) + uint32_t(p11[c]) + 2) / 4);
+                }
+            }
+        }
+    }
+
+    // gather the 4x4 block at block coordinates bx, by, clamping at the image edges
+    void gatherBlock(const MipmapLevel& level, uint32_t bx, uint32_t by, vsg::ubvec4 block[16])
+    {
+        for (uint32_t j = 0; j < 4; ++j)
+        {
+            uint32_t y = std::min(by * 4 + j, level.height - 1);
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                uint32_t x = std::min(bx * 4 + i, level.width - 1);
+                block[i + j * 4] = level.pixels[x + y * level.width];
+            }
+        }
+    }
+
+    uint16_t packRGB565(int r, int g, int b)
+    {
+        return static_cast<uint16_t>((((r * 31 + 127) / 255) << 11) | (((g * 63 + 127) / 255) << 5) | ((b * 31 + 127) / 255));
+    }
+
+    void unpackRGB565(uint16_t c, int rgb[3])
+    {
+        int r = (c >> 11) & 31;
+        int g = (c >> 5) & 63;
+        int b = c & 31;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    // BC1 colour block using the inset bounding box of the block's colours as end points, always in the 4 colour mode so it's also valid for BC3
+    uint64_t encodeColorBlock(const vsg::ubvec4 block[16])
+    {
+        int minColor[3] = {255, 255, 255};
+        int maxColor[3] = {0, 0, 0};
+        for (int t = 0; t < 16; ++t)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                minColor[c] = std::min(minColor[c], int(block[t][c]));
+                maxColor[c] = std::max(maxColor[c], int(block[t][c]));
+            }
+        }
+
+        // inset by 1/16 of the range to reduce the error at the interpolated colours
+        for (int c = 0; c < 3; ++c)
+        {
+            int inset = (maxColor[c] - minColor[c]) / 16;
+            minColor[c] += inset;
+            maxColor[c] -= inset;
+        }
+
+        uint16_t color0 = packRGB565(maxColor[0], maxColor[1], maxColor[2]);
+        uint16_t color1 = packRGB565(minColor[0], minColor[1], minColor[2]);
+        if (color0 < color1) std::swap(color0, color1);
+
+        uint64_t bits = uint64_t(color0) | (uint64_t(color1) << 16);
+        if (color0 == color1) return bits; // all indices 0
+
+        int palette[4][3];
+        unpackRGB565(color0, palette[0]);
+        unpackRGB565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (int t = 0; t < 16; ++t)
+        {
+            int bestIndex = 0;
+            int bestDistance = std::numeric_limits<int>::max();
+            for (int p = 0; p < 4; ++p)
+            {
+                int dr = int(block[t][0]) - palette[p][0];
+                int dg = int(block[t][1]) - palette[p][1];
+                int db = int(block[t][2]) - palette[p][2];
+                int distance = dr * dr + dg * dg + db * db;
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = p;
+                }
+            }
+            bits |= uint64_t(bestIndex) << (32 + t * 2);
+        }
+        return bits;
+    }
+
+    // BC3 alpha block using the block's alpha range as end points in the 8 alpha mode
+    uint64_t encodeAlphaBlock(const vsg::ubvec4 block[16])
+    {
+        int minAlpha = 255;
+        int maxAlpha = 0;
+        for (int t = 0; t < 16; ++t)
+        {
+            minAlpha = std::min(minAlpha, int(block[t].a));
+            maxAlpha = std::max(maxAlpha, int(block[t].a));
+        }
+
+        uint64_t bits = uint64_t(maxAlpha) | (uint64_t(minAlpha) << 8);
+        if (maxAlpha == minAlpha) return bits; // all indices 0
+
+        int palette[8];
+        palette[0] = maxAlpha;
+        palette[1] = minAlpha;
+        for (int p = 1; p < 7; ++p) palette[p + 1] = ((7 - p) * maxAlpha + p * minAlpha) / 7;
+
+        for (int t = 0; t < 16; ++t)
+        {
+            int bestIndex = 0;
+            int bestDistance = std::numeric_limits<int>::max();
+            for (int p = 0; p < 8; ++p)
+            {
+                int distance = std::abs(int(block[t].a) - palette[p]);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = p;
+                }
+            }
+            bits |= uint64_t(bestIndex) << (16 + t * 3);
+        }
+        return bits;
+    }
+
+    // compress all the mipmap levels into contiguous storage for the block type T, each block stored as little endian 64 bit words
+    template<typename T>
+    vsg::ref_ptr<vsg::Data> compressLevels(const std::vector<MipmapLevel>& levels, vsg::Data::Layout layout, vsgGIS::TileDataPool* pool)
+    {
+        size_t numBlocks = 0;
+        for (auto& level : levels) numBlocks += ((level.width + 3) / 4) * ((level.height + 3) / 4);
+
+        auto storage = vsgGIS::createArray<T>(pool, static_cast<uint32_t>(numBlocks));
+        T* dest = storage->data();
+
+        vsg::ubvec4 block[16];
+        for (auto& level : levels)
+        {
+            uint32_t numBlocksX = (level.width + 3) / 4;
+            uint32_t numBlocksY = (level.height + 3) / 4;
+            for (uint32_t by = 0; by < numBlocksY; ++by)
+            {
+                for (uint32_t bx = 0; bx < numBlocksX; ++bx)
+                {
+                    gatherBlock(level, bx, by, block);
+
+                    uint64_t words[2];
+                    if constexpr (sizeof(T) == 8)
+                    {
+                        words[0] = encodeColorBlock(block);
+                    }
+                    else
+                    {
+                        words[0] = encodeAlphaBlock(block);
+                        words[1] = encodeColorBlock(block);
+                    }
+                    std::memcpy(dest++, words, sizeof(T));
+                }
+            }
+        }
+
+        // the Array2D views the full mipmap chain held in storage
+        uint32_t numBlocksX = (levels.front().width + 3) / 4;
+        uint32_t numBlocksY = (levels.front().height + 3) / 4;
+        return vsg::Array2D<T>::create(storage, 0, sizeof(T), numBlocksX, numBlocksY, layout);
+    }
+
+    template<typename T>
+    vsg::ref_ptr<vsg::Data> stackLayers(const vsg::DataList& layers, vsgGIS::TileDataPool* pool)
+    {
+        auto first = layers.front().cast<vsg::Array2D<T>>();
+        if (!first) return {};
+
+        uint32_t width = first->width();
+        uint32_t height = first->height();
+        size_t layerSize = size_t(width) * size_t(height);
+
+        auto layout = first->getLayout();
+        layout.maxNumMipmaps = 0;
+        layout.imageViewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+
+        auto array = vsgGIS::createArray3D<T>(pool, width, height, static_cast<uint32_t>(layers.size()), layout);
+        T* dest = array->data();
+        for (auto& layer : layers)
+        {
+            auto src = layer.cast<vsg::Array2D<T>>();
+            std::copy(src->data(), src->data() + layerSize, dest);
+            dest += layerSize;
+        }
+        return array;
+    }
+
+    template<typename T>
+    vsg::ref_ptr<vsg::Data> upsampleArray(const vsg::Data& image, uint32_t quadrantX, uint32_t quadrantY, vsgGIS::TileDataPool* pool)
+    {
+        auto src = dynamic_cast<const vsg::Array2D<T>*>(&image);
+        if (!src) return {};
+
+        uint32_t width = src->width();
+        uint32_t height = src->height();
+        uint32_t offsetX = quadrantX * (width / 2);
+        uint32_t offsetY = quadrantY * (height / 2);
+
+        auto layout = src->getLayout();
+        layout.maxNumMipmaps = 0;
+
+        auto array = vsgGIS::createArray2D<T>(pool, width, height, layout);
+        T* dest = array->data();
+        for (uint32_t j = 0; j < height; ++j)
+        {
+            const T* src_row = src->data() + std::min(offsetY + j / 2, height - 1) * width;
+            for (uint32_t i = 0; i < width; ++i)
+            {
+                *(dest++) = src_row[std::min(offsetX + i / 2, width - 1)];
+            }
+        }
+        return array;
+    }
+
+    // box filter the image into a mipmap chain of numMipmaps levels held in contiguous storage, each value of type T is treated as sizeof(T) / sizeof(C) components of type C
+    template<typename C, typename T>
+    vsg::ref_ptr<vsg::Data> mipmapArray(const vsg::Data& image, uint32_t numMipmaps, vsgGIS::TileDataPool* pool)
+    {
+        auto src = dynamic_cast<const vsg::Array2D<T>*>(&image);
+        if (!src || (src->getLayout().stride != 0 && src->getLayout().stride != sizeof(T))) return {};
+
+        constexpr uint32_t numComponents = sizeof(T) / sizeof(C);
+        using Sum = std::conditional_t<std::is_floating_point_v<C>, double, int64_t>;
+
+        uint32_t width = src->width();
+        uint32_t height = src->height();
+
+        size_t numValues = 0;
+        for (uint32_t i = 0, w = width, h = height; i < numMipmaps; ++i, w = std::max(1u, w / 2), h = std::max(1u, h / 2)) numValues += size_t(w) * size_t(h);
+
+        auto storage = vsgGIS::createArray<T>(pool, static_cast<uint32_t>(numValues));
+        T* level = storage->data();
+        std::copy(src->data(), src->data() + size_t(width) * size_t(height), level);
+
+        uint32_t w = width, h = height;
+        for (uint32_t i = 1; i < numMipmaps; ++i)
+        {
+            uint32_t nw = std::max(1u, w / 2);
+            uint32_t nh = std::max(1u, h / 2);
+            T* next = level + size_t(w) * size_t(h);
+
+            auto s = reinterpret_cast<const C*>(level);
+            auto d = reinterpret_cast<C*>(next);
+            for (uint32_t j = 0; j < nh; ++j)
+            {
+                const C* row0 = s + size_t(std::min(j * 2, h - 1)) * w * numComponents;
+                const C* row1 = s + size_t(std::min(j * 2 + 1, h - 1)) * w * numComponents;
+                for (uint32_t x = 0; x < nw; ++x)
+                {
+                    uint32_t i0 = std::min(x * 2, w - 1) * numComponents;
+                    uint32_t i1 = std::min(x * 2 + 1, w - 1) * numComponents;
+                    for (uint32_t c = 0; c < numComponents; ++c)
+                    {
+                        Sum sum = Sum(row0[i0 + c]) + Sum(row0[i1 + c]) + Sum(row1[i0 + c]) + Sum(row1[i1 + c]);
+                        if constexpr (std::is_floating_point_v<C>)
+                            *(d++) = static_cast<C>(sum * 0.25);
+                        else
+                            *(d++) = static_cast<C>((sum + 2) / 4);
+                    }
+                }
+            }
+
+            level = next;
+            w = nw;
+            h = nh;
+        }
+
+        auto layout = src->getLayout();
+        layout.maxNumMipmaps = static_cast<uint8_t>(numMipmaps);
+
+        // the Array2D views the full mipmap chain held in storage
+        return vsg::Array2D<T>::create(storage, 0, sizeof(T), width, height, layout);
+    }
+
+    // 8 bit RGB formats are rarely supported for sampling so expand to RGBA
+    vsg::ref_ptr<vsg::Data> stackRGBLayers(const vsg::DataList& layers, vsgGIS::TileDataPool* pool)
+    {
+        auto first = layers.front().cast<vsg::ubvec3Array2D>();
+        if (!first) return {};
+
+        uint32_t width = first->width();
+        uint32_t height = first->height();
+        size_t layerSize = size_t(width) * size_t(height);
+
+        auto layout = first->getLayout();
+        layout.format = (layout.format == VK_FORMAT_R8G8B8_SRGB) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+        layout.maxNumMipmaps = 0;
+        layout.imageViewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+
+        auto array = vsgGIS::createArray3D<vsg::ubvec4>(pool, width, height, static_cast<uint32_t>(layers.size()), layout);
+        vsg::ubvec4* dest = array->data();
+        for (auto& layer : layers)
+        {
+            const vsg::ubvec3* src = layer.cast<vsg::ubvec3Array2D>()->data();
+            for (size_t i = 0; i < layerSize; ++i, ++src, ++dest) dest->set(src->r, src->g, src->b, 255);
+        }
+        return array;
+    }
+} // namespace
+
+bool vsgGIS::isSupportedCompressedFormat(VkFormat format)
+{
+    return format == VK_FORMAT_BC1_RGB_UNORM_BLOCK || format == VK_FORMAT_BC3_UNORM_BLOCK;
+}
+
+vsg::ref_ptr<vsg::Data> vsgGIS::compressImage(const vsg::Data& image, VkFormat format, uint32_t maxNumMipmaps, TileDataPool* pool)
+{
+    if (!isSupportedCompressedFormat(format)) return {};
+
+    auto& sourceLayout = image.getLayout();
+    if (sourceLayout.blockWidth > 1 || sourceLayout.blockHeight > 1) return {}; // already compressed
+
+    bool sRGB = sourceLayout.format == VK_FORMAT_R8G8B8A8_SRGB || sourceLayout.format == VK_FORMAT_R8G8B8_SRGB;
+
+    std::vector<MipmapLevel> levels(1);
+    if (!copyToLevel(image, levels.front())) return {};
+
+    // generate the mipmap chain on the CPU as mipmaps can't be generated on the GPU for compressed formats
+    uint32_t numMipmaps = computeNumMipmaps(levels.front().width, levels.front().height, maxNumMipmaps);
+
+    levels.resize(numMipmaps);
+    for (uint32_t i = 1; i < numMipmaps; ++i) downsample(levels[i - 1], levels[i]);
+
+    vsg::Data::Layout layout;
+    layout.blockWidth = 4;
+    layout.blockHeight = 4;
+    layout.maxNumMipmaps = static_cast<uint8_t>(numMipmaps);
+    layout.origin = sourceLayout.origin;
+
+    if (format == VK_FORMAT_BC1_RGB_UNORM_BLOCK)
+    {
+        layout.format = sRGB ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        return compressLevels<vsg::block64>(levels, layout, pool);
+    }
+    else
+    {
+        layout.format = sRGB ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+        return compressLevels<vsg::block128>(levels, layout, pool);
+    }
+}
+
+uint32_t vsgGIS::computeNumMipmaps(uint32_t width, uint32_t height, uint32_t maxNumMipmaps, uint32_t minMipmapSize)
+{
+    uint32_t numMipmaps = 1;
+    for (uint32_t size = std::max(width, height); size > 1 && size / 2 >= minMipmapSize; size /= 2) ++numMipmaps;
+    return std::max(1u, std::min(numMipmaps, std::min(maxNumMipmaps, 255u)));
+}
+
+vsg::ref_ptr<vsg::Data> vsgGIS::generateMipmaps(const vsg::Data& image, uint32_t maxNumMipmaps, uint32_t minMipmapSize, TileDataPool* pool)
+{
+    auto& layout = image.getLayout();
+    if (image.dimensions() != 2 || layout.blockWidth != 1 || layout.blockHeight != 1 || layout.maxNumMipmaps > 1) return {};
+
+    uint32_t numMipmaps = computeNumMipmaps(image.width(), image.height(), maxNumMipmaps, minMipmapSize);
+    if (numMipmaps <= 1) return {};
+
+    vsg::ref_ptr<vsg::Data> mipmapped;
+    if ((mipmapped = mipmapArray<uint8_t, vsg::ubvec4>(image, numMipmaps, pool))) return mipmapped;
+    if ((mipmapped = mipmapArray<uint8_t, vsg::ubvec3>(image, numMipmaps, pool))) return mipmapped;
+    if ((mipmapped = mipmapArray<uint8_t, vsg::ubvec2>(image, numMipmaps, pool))) return mipmapped;
+    if ((mipmapped = mipmapArray<uint8_t, uint8_t>(image, numMipmaps, pool))) return mipmapped;
+    if ((mipmapped = mipmapArray<uint16_t, vsg::usvec4>(image, numMipmaps, pool))) return mipmapped;
+    if ((mipmapped = mipmapArray<uint16_t, uint16_t>(image, numMipmaps, pool))) return mipmapped;
+    if ((mipmapped = mipmapArray<int16_t, int16_t>(image, numMipmaps, pool))) return mipmapped;
+    if ((mipmapped = mipmapArray<float, vsg::vec4>(image, numMipmaps, pool))) return mipmapped;
+    return mipmapArray<float, float>(image, numMipmaps, pool);
+}
+
+bool vsgGIS::compatibleTextureLayers(const vsg::Data& lhs, const vsg::Data& rhs)
+{
+    auto& lhsLayout = lhs.getLayout();
+    auto& rhsLayout = rhs.getLayout();
+    return typeid(lhs) == typeid(rhs) && lhs.dimensions() == 2 &&
+           lhs.width() == rhs.width() && lhs.height() == rhs.height() &&
+           lhsLayout.format == rhsLayout.format && lhsLayout.origin == rhsLayout.origin &&
+           lhsLayout.blockWidth == 1 && lhsLayout.blockHeight == 1;
+}
+
+vsg::ref_ptr<vsg::Data> vsgGIS::createTextureArray(const vsg::DataList& layers, TileDataPool* pool)
+{
+    if (layers.empty() || !layers.front()) return {};
+
+    for (auto& layer : layers)
+    {
+        if (!layer || !compatibleTextureLayers(*layers.front(), *layer)) return {};
+    }
+
+    vsg::ref_ptr<vsg::Data> array;
+    if ((array = stackLayers<vsg::ubvec4>(layers, pool))) return array;
+    if ((array = stackRGBLayers(layers, pool))) return array;
+    if ((array = stackLayers<uint8_t>(layers, pool))) return array;
+    if ((array = stackLayers<uint16_t>(layers, pool))) return array;
+    return stackLayers<float>(layers, pool);
+}
+
+vsg::ref_ptr<vsg::Data> vsgGIS::upsampleQuadrant(const vsg::Data& image, uint32_t quadrantX, uint32_t quadrantY, TileDataPool* pool)
+{
+    if (image.dimensions() != 2 || image.getLayout().blockWidth != 1 || image.getLayout().blockHeight != 1) return {};
+
+    vsg::ref_ptr<vsg::Data> upsampled;
+    if ((upsampled = upsampleArray<vsg::ubvec4>(image, quadrantX, quadrantY, pool))) return upsampled;
+    if ((upsampled = upsampleArray<vsg::ubvec3>(image, quadrantX, quadrantY, pool))) return upsampled;
+    if ((upsampled = upsampleArray<uint8_t>(image, quadrantX, quadrantY, pool))) return upsampled;
+    if ((upsampled = upsampleArray<uint16_t>(image, quadrantX, quadrantY, pool))) return upsampled;
+    if ((upsampled = upsampleArray<int16_t>(image, quadrantX, quadrantY, pool))) return upsampled;
+    if ((upsampled = upsampleArray<uint32_t>(image, quadrantX, quadrantY, pool))) return upsampled;
+    if ((upsampled = upsampleArray<int32_t>(image, quadrantX, quadrantY, pool))) return upsampled;
+    if ((upsampled = upsampleArray<float>(image, quadrantX, quadrantY, pool))) return upsampled;
+    if ((upsampled = upsampleArray<vsg::vec4>(image, quadrantX, quadrantY, pool))) return upsampled;
+    return upsampleArray<double>(image, quadrantX, quadrantY, pool);
+}